@@ -0,0 +1,47 @@
+/**
+ * @file allocations.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief counting of the allocations module
+ *
+ * This module contains the counting of the allocations implementation.
+ * The operators are in their own module, so they are not inlined into
+ * the callers.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "allocations.h"
+
+namespace {
+    /** @brief Count of the allocations. */
+    std::atomic<unsigned long long> Count(0);
+}
+
+unsigned long long Allocations::getCount() { return Count.load(std::memory_order_relaxed); }
+
+/**
+ * @brief Allocates the memory and counts it.
+ * @param size      Size.
+ * @returns Memory.
+ */
+void* operator new(size_t size)
+{
+    Count.fetch_add(1, std::memory_order_relaxed);
+    if(void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+/**
+ * @brief Frees the memory.
+ * @param p         Memory.
+ */
+void operator delete(void* p) noexcept { std::free(p); }
+
+/**
+ * @brief Frees the memory.
+ * @param p         Memory.
+ */
+void operator delete(void* p, size_t) noexcept { std::free(p); }
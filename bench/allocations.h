@@ -0,0 +1,26 @@
+/**
+ * @file allocations.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief counting of the allocations interface
+ *
+ * This module replaces the global operator new of the benchmarks, so
+ * every allocation on the heap is counted.
+ */
+
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+/**
+ * @brief Namespace of the counting of the allocations.
+ */
+namespace Allocations
+{
+    /**
+     * @brief Count getter.
+     * @returns Count of the allocations since the start.
+     */
+    unsigned long long getCount();
+}
+
+#endif // ALLOCATIONS_H
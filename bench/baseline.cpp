@@ -0,0 +1,92 @@
+/**
+ * @file baseline.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief baseline of the benchmarks module
+ *
+ * This module contains the baseline of the benchmarks implementation.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "baseline.h"
+#include "defs.h"
+
+namespace {
+    /**
+     * @brief Median.
+     * @param v         Sorted samples (not empty).
+     * @returns Median.
+     */
+    double median(const std::vector<double>& v)
+    {
+        size_t n = v.size();
+        return (n % 2 == 1) ? v[n/2] : (v[n/2 - 1] + v[n/2]) / 2;
+    }
+}
+
+Measurement Baseline::summarize(const std::string& benchmark, const std::string& phase,
+                                std::vector<double> times, std::vector<double> allocations)
+{
+    std::sort(times.begin(), times.end());
+    std::sort(allocations.begin(), allocations.end());
+    Measurement m;
+    m.benchmark = benchmark;
+    m.phase = phase;
+    m.median = median(times);
+    m.allocations = median(allocations);
+    // ranks of the order statistics around the median (normal approximation
+    // of the binomial distribution), the whole range for a few repetitions
+    const double n = double(times.size());
+    const double d = 1.96 * std::sqrt(n) / 2;
+    long lo = long(std::floor(n / 2 - d)), hi = long(std::ceil(n / 2 + d));
+    m.lo = times[size_t(std::max(lo, 0L))];
+    m.hi = times[size_t(std::min(hi, long(times.size()) - 1))];
+    return m;
+}
+
+std::map<std::string, Measurement> Baseline::load(const std::string& path)
+{
+    std::ifstream is(path);
+    if(!is) throw MyError("Cannot open "+path, ErrorType::BlockError);
+    std::map<std::string, Measurement> r;
+    std::string s;
+    while(getline(is, s))
+    {
+        if(s.empty() || s[0] == '#') continue;
+        std::istringstream ls(s);
+        Measurement m;
+        if(!(ls >> m.benchmark >> m.phase >> m.median >> m.lo >> m.hi >> m.allocations))
+            throw MyError("Invalid baseline "+path, ErrorType::BlockError);
+        r[m.benchmark + "/" + m.phase] = m;
+    }
+    return r;
+}
+
+void Baseline::save(const std::string& path, const std::vector<Measurement>& m)
+{
+    std::ofstream os(path);
+    if(!os) throw MyError("Cannot write "+path, ErrorType::BlockError);
+    os << "# benchmark phase median_ms ci_lo_ms ci_hi_ms allocations\n";
+    for(auto& it: m)
+    {
+        os << it.benchmark << " " << it.phase << " " << it.median << " "
+           << it.lo << " " << it.hi << " " << it.allocations << "\n";
+    }
+}
+
+bool Baseline::regressed(const Measurement& base, const Measurement& m, double threshold, double speed,
+                         std::string& message)
+{
+    std::ostringstream os;
+    bool slower = m.median > base.median * speed * (1 + threshold) && m.lo > base.hi * speed;
+    bool allocates = m.allocations > base.allocations * (1 + threshold);
+    if(slower) os << "time " << base.median * speed << " ms (calibrated) -> " << m.median << " ms";
+    if(slower && allocates) os << ", ";
+    if(allocates) os << "allocations " << base.allocations << " -> " << m.allocations;
+    message = os.str();
+    return slower || allocates;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file baseline.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief baseline of the benchmarks interface
+ *
+ * This module keeps the measured phases of the benchmarks in the text file
+ * (bench/baseline.txt) and compares the new measurements with them. The time
+ * is the median of the repetitions with its confidence interval, so the
+ * noise of one slow repetition does not fail the check. The time regresses
+ * only when the median is over the threshold and the intervals do not
+ * overlap, the count of the allocations (which is stable) only by the threshold.
+ * The baseline must be recorded on the machine, which checks it. On demand,
+ * the times are corrected by the calibration (fixed work measured with them)
+ * for a different machine, by 1.5 times at most, so the real regression is
+ * not hidden by the calibration, which does not load the machine like the phases.
+ */
+
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Measured phase of the benchmark.
+ */
+struct Measurement {
+    std::string benchmark; /**< Name of the benchmark. */
+    std::string phase; /**< Name of the phase. */
+    double median = 0; /**< Median of the time in milliseconds. */
+    double lo = 0; /**< Lower bound of the confidence interval of the median. */
+    double hi = 0; /**< Upper bound of the confidence interval of the median. */
+    double allocations = 0; /**< Median of the count of the allocations. */
+};
+
+/**
+ * @brief Namespace of the baseline functions.
+ */
+namespace Baseline
+{
+    /**
+     * @brief Summarizes the repetitions.
+     * @param benchmark     Name of the benchmark.
+     * @param phase         Name of the phase.
+     * @param times         Times of the repetitions (not empty).
+     * @param allocations   Counts of the allocations of the repetitions (not empty).
+     * @returns Measurement with the 95% confidence interval of the median.
+     */
+    Measurement summarize(const std::string& benchmark, const std::string& phase,
+                          std::vector<double> times, std::vector<double> allocations);
+    /**
+     * @brief Reads the baseline.
+     * @param path      Path to the file.
+     * @returns Measurements by "benchmark/phase".
+     */
+    std::map<std::string, Measurement> load(const std::string& path);
+    /**
+     * @brief Writes the baseline.
+     * @param path      Path to the file.
+     * @param m         Measurements.
+     */
+    void save(const std::string& path, const std::vector<Measurement>& m);
+    /**
+     * @brief Compares the measurement with the baseline.
+     * @param base      Baseline.
+     * @param m         New measurement.
+     * @param threshold Allowed relative growth (0.25 is 25 %).
+     * @param speed     Time of the calibration now relative to the baseline (the times of the baseline are scaled by it).
+     * @param message   Description of the regression.
+     * @returns True, if the measurement regressed.
+     */
+    bool regressed(const Measurement& base, const Measurement& m, double threshold, double speed, std::string& message);
+}
+
+#endif // BASELINE_H
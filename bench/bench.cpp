@@ -0,0 +1,242 @@
+/**
+ * @file bench.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief benchmarks of the model
+ *
+ * This module times the phases of the work with the generated schemes:
+ * load (parsing of the .bsc file), build (blocks and wires in the model,
+ * the levels are propagated by slotCreateWire), evaluate (startComputation)
+ * and save (writing of the .bsc file). Every phase is repeated, the median
+ * and its confidence interval are printed. It is built without Qt (make bench).
+ * The allocations of every phase are counted (see allocations.h).
+ * With --check, the phases are compared with the baseline and the exit
+ * code is 1, when any of them regressed (make bench-check). With --update,
+ * the baseline is written.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "allocations.h"
+#include "baseline.h"
+#include "config.h"
+#include "defs.h"
+#include "generator.h"
+#include "model.h"
+#include "scheme.h"
+
+namespace {
+    /** @brief Usage of the benchmarks. */
+    const char* Usage =
+        "usage: bench [options]\n"
+        "  --reps N         repetitions of every phase (default 5)\n"
+        "  --seed S         seed of the generated schemes (default 1)\n"
+        "  --scale K        multiplies the sizes of the schemes (default 1)\n"
+        "  --filter TEXT    runs only the benchmarks containing the text\n"
+        "  --check FILE     compares with the baseline, fails on the regression\n"
+        "  --update FILE    writes the baseline\n"
+        "  --threshold T    allowed relative growth of the time and the allocations (default 0.25)\n"
+        "  --calibrate      scales the times of the baseline by the speed of the machine (at most 1.5 times)\n";
+
+    /** @brief Largest correction of the times of the baseline by the calibration. */
+    const double MaxSpeed = 1.5;
+
+    /**
+     * @brief Benchmark.
+     */
+    struct Benchmark {
+        std::string name; /**< Name. */
+        std::function<SchemeFile(size_t scale, unsigned long long seed)> make; /**< Generator of the scheme. */
+    };
+
+    /** @brief Benchmarks. */
+    const std::vector<Benchmark> Benchmarks = {
+        {"chain", [](size_t k, unsigned long long s) { return Generator::chain(300 * k, s); }},
+        {"tree2", [](size_t k, unsigned long long s) { return Generator::tree(4096 * k, 2, s); }},
+        {"tree16", [](size_t k, unsigned long long s) { return Generator::tree(4096 * k, 16, s); }},
+        {"dag", [](size_t k, unsigned long long s) { return Generator::dag(20 * k, 20, s); }},
+        {"mix", [](size_t k, unsigned long long s) { return Generator::mix(500 * k, s); }},
+    };
+
+    /** @brief Phases. */
+    const char* Phases[] = {"load", "build", "evaluate", "save"};
+
+    /**
+     * @brief Time of the call.
+     * @param f         Call.
+     * @param allocations   Count of the allocations of the call is added here.
+     * @returns Time in milliseconds.
+     */
+    double measure(const std::function<void()>& f, std::vector<double>& allocations)
+    {
+        unsigned long long a = Allocations::getCount();
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        allocations.push_back(double(Allocations::getCount() - a));
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    /**
+     * @brief Measures the speed of the machine by the fixed work (the map
+     *        and the math, like the model does).
+     * @param reps      Repetitions.
+     * @returns Measurement of the "calibration" benchmark.
+     */
+    Measurement calibrate(size_t reps)
+    {
+        std::vector<double> times, allocations;
+        for(size_t r = 0; r <= reps; r++)
+        {
+            times.push_back(measure([]() {
+                std::map<long, double> m;
+                for(long i = 0; i < 200000; i++) m[(i * 7919) % 100003] += std::sqrt(double(i));
+                volatile double x = 0;
+                for(auto& it: m) x = x + it.second;
+            }, allocations));
+        }
+        times.erase(times.begin());
+        allocations.erase(allocations.begin());
+        return Baseline::summarize("calibration", "reference", times, allocations);
+    }
+
+    /**
+     * @brief Runs the benchmark.
+     * @param b         Benchmark.
+     * @param reps      Repetitions.
+     * @param scale     Multiplier of the size.
+     * @param seed      Seed.
+     * @returns Measurements of the phases.
+     */
+    std::vector<Measurement> run(const Benchmark& b, size_t reps, size_t scale, unsigned long long seed)
+    {
+        SchemeFile f = b.make(scale, seed);
+        std::ostringstream os;
+        Scheme::write(os, f);
+        const std::string text = os.str();
+
+        std::vector<std::vector<double>> times(4), allocations(4);
+        // the first repetition warms the caches up and it is dropped
+        for(size_t r = 0; r <= reps; r++)
+        {
+            times[0].push_back(measure([&]() {
+                std::istringstream is(text);
+                f = Scheme::read(is);
+            }, allocations[0]));
+            Model m;
+            times[1].push_back(measure([&]() { Scheme::build(f, m); }, allocations[1]));
+            times[2].push_back(measure([&]() {
+                try { m.startComputation(); }
+                catch(const char* e) { throw MyError(e, ErrorType::BlockError); }
+            }, allocations[2]));
+            times[3].push_back(measure([&]() {
+                std::ostringstream out;
+                Scheme::write(out, f);
+            }, allocations[3]));
+        }
+        std::vector<Measurement> r;
+        for(size_t p = 0; p < 4; p++)
+        {
+            times[p].erase(times[p].begin());
+            allocations[p].erase(allocations[p].begin());
+            r.push_back(Baseline::summarize(b.name, Phases[p], times[p], allocations[p]));
+            std::printf("%-10s %7zu %7zu  %-9s %12.3f %12.3f %12.3f %12.0f\n", b.name.c_str(), f.blocks.size(),
+                        f.wires.size(), Phases[p], r.back().median, r.back().lo, r.back().hi, r.back().allocations);
+        }
+        return r;
+    }
+}
+
+/**
+ * @brief Main function of the benchmarks.
+ * @param argc      Count of the arguments.
+ * @param argv      Arguments.
+ * @returns Exit code.
+ */
+int main(int argc, char* argv[])
+{
+    size_t reps = 5, scale = 1;
+    unsigned long long seed = 1;
+    double threshold = 0.25;
+    std::string filter, check, update;
+    bool calibrated = false;
+    try
+    {
+        for(int i = 1; i < argc; i++)
+        {
+            std::string a = argv[i];
+            if(a == "--calibrate") { calibrated = true; continue; }
+            if(i + 1 >= argc) throw MyError("Missing value of "+a, ErrorType::BlockError);
+            std::string v = argv[++i];
+            if(a == "--reps") reps = std::max<size_t>(std::stoul(v), 1);
+            else if(a == "--seed") seed = std::stoull(v);
+            else if(a == "--scale") scale = std::max<size_t>(std::stoul(v), 1);
+            else if(a == "--filter") filter = v;
+            else if(a == "--check") check = v;
+            else if(a == "--update") update = v;
+            else if(a == "--threshold") threshold = std::stod(v);
+            else throw MyError("Unknown option "+a, ErrorType::BlockError);
+        }
+
+        std::map<std::string, Measurement> base;
+        if(!check.empty()) base = Baseline::load(check);
+
+        Config::initConfig();
+        std::printf("%-10s %7s %7s  %-9s %12s %12s %12s %12s\n", "benchmark", "blocks", "wires", "phase",
+                    "median ms", "ci lo ms", "ci hi ms", "allocations");
+        std::vector<Measurement> all{calibrate(reps)};
+        std::printf("%-10s %7s %7s  %-9s %12.3f %12.3f %12.3f %12.0f\n", "calibration", "-", "-", "reference",
+                    all[0].median, all[0].lo, all[0].hi, all[0].allocations);
+        for(auto& it: Benchmarks)
+        {
+            if(it.name.find(filter) == std::string::npos) continue;
+            std::vector<Measurement> m = run(it, reps, scale, seed);
+            all.insert(all.end(), m.begin(), m.end());
+        }
+        if(!update.empty()) Baseline::save(update, all);
+
+        // the calibration does not load the machine like the phases do, so it only
+        // corrects a different machine on demand, and by a limited factor
+        double speed = 1;
+        if(calibrated && base.count("calibration/reference") > 0)
+        {
+            speed = all[0].median / base["calibration/reference"].median;
+            speed = std::max(1 / MaxSpeed, std::min(MaxSpeed, speed));
+        }
+        int regressions = 0;
+        for(size_t i = 1; i < all.size(); i++)
+        {
+            const Measurement& it = all[i];
+            auto b = base.find(it.benchmark + "/" + it.phase);
+            std::string message;
+            if(b == base.end() || !Baseline::regressed(b->second, it, threshold, speed, message)) continue;
+            std::fprintf(stderr, "REGRESSION %s %s: %s\n", it.benchmark.c_str(), it.phase.c_str(), message.c_str());
+            regressions++;
+        }
+        if(!check.empty() && calibrated)
+            std::printf("%d regression(s) over %.0f %% (machine speed %.2f of the baseline)\n",
+                        regressions, threshold * 100, 1 / speed);
+        else if(!check.empty())
+            std::printf("%d regression(s) over %.0f %%\n", regressions, threshold * 100);
+        if(regressions > 0) return 1;
+    }
+    catch(MyError& e)
+    {
+        std::fprintf(stderr, "%s\n%s", e.getMessage().c_str(), Usage);
+        return 1;
+    }
+    catch(std::exception& e)
+    {
+        std::fprintf(stderr, "Invalid argument\n%s", Usage);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,224 @@
+/**
+ * @file generator.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief synthetic scheme generator module
+ *
+ * This module contains the synthetic scheme generator implementation.
+ */
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "generator.h"
+
+namespace {
+    /** @brief Distance of the blocks in the scene. */
+    const double Spacing = 80;
+
+    /**
+     * @brief Makes the scheme block after block.
+     */
+    class Builder
+    {
+        public:
+            /**
+             * @brief Builder constructor.
+             * @param seed      Seed.
+             */
+            Builder(unsigned long long seed): mrandom(seed)
+            {
+                mfile.types.push_back("general");
+            }
+
+            /**
+             * @brief Random number in [0,1). Made of the raw bits, so it
+             *        is the same with every standard library.
+             * @returns Number.
+             */
+            double uniform() { return double(mrandom() >> 11) * 0x1.0p-53; }
+            /**
+             * @brief Random index.
+             * @param n         Count (not 0).
+             * @returns Index below n.
+             */
+            size_t below(size_t n) { return size_t(mrandom() % n); }
+
+            /**
+             * @brief Adds the input with the random value in [-2,2).
+             * @param level     Column in the scene.
+             * @returns ID of the input.
+             */
+            long input(size_t level)
+            {
+                GuiBlockDescriptor g;
+                g.type = -1;
+                g.val.type = "general";
+                g.val.value = 4 * uniform() - 2;
+                g.val.valid = true;
+                return add(g, level);
+            }
+            /**
+             * @brief Adds the block and its input wires. The risky operands are made positive.
+             * @param name      Name of the type (see Config::getBlockNames).
+             * @param sources   IDs of the blocks connected to the inputs.
+             * @param level     Column in the scene.
+             * @param safe      Operands are made positive, if true.
+             * @returns ID of the block.
+             */
+            long block(const std::string& name, std::vector<long> sources, size_t level, bool safe = true)
+            {
+                long type = Config::getBlockNames().at(name);
+                if(safe && (name == "ln" || name == "sqrt")) sources[0] = positive(sources[0], level);
+                if(safe && name == "divider") sources[1] = positive(sources[1], level);
+
+                GuiBlockDescriptor g;
+                g.type = type;
+                g.val.type = "general";
+                if(Config::decodeBlockType(type) == BlockType::NIn_OneOut) g.ports = int(sources.size());
+                long id = add(g, level);
+                for(size_t i = 0; i < sources.size(); i++)
+                    mfile.wires.push_back({int(sources[i]), int(id), -1, int(i)});
+                return id;
+            }
+            /**
+             * @brief Count of the inputs of the type.
+             * @param name      Name of the type.
+             * @returns Count (0 if it is N).
+             */
+            static size_t arity(const std::string& name)
+            {
+                switch(Config::decodeBlockType(Config::getBlockNames().at(name)))
+                {
+                    case BlockType::OneIn_OneOut: return 1;
+                    case BlockType::TwoIn_OneOut: return 2;
+                    default: return 0;
+                }
+            }
+
+            /**
+             * @brief Scheme getter.
+             * @returns Scheme.
+             */
+            const SchemeFile& getFile() const { return mfile; }
+
+        private:
+            SchemeFile mfile; /**< Scheme. */
+            std::mt19937_64 mrandom; /**< Random generator. */
+            std::vector<size_t> mrows; /**< Blocks in each column. */
+
+            /**
+             * @brief Adds the block to the next free place of the column.
+             * @param g         Block.
+             * @param level     Column.
+             * @returns ID of the block.
+             */
+            long add(GuiBlockDescriptor g, size_t level)
+            {
+                if(mrows.size() <= level) mrows.resize(level + 1, 0);
+                g.pos = std::make_pair(double(level) * Spacing, double(mrows[level]++) * Spacing);
+                long id = long(mfile.blocks.size());
+                mfile.blocks.insert( std::make_pair(id, g) );
+                return id;
+            }
+            /**
+             * @brief Makes the value positive (ex of abs).
+             * @param source    ID of the block with the value.
+             * @param level     Column in the scene.
+             * @returns ID of the block with the positive value.
+             */
+            long positive(long source, size_t level)
+            {
+                long a = block("abs", {source}, level, false);
+                return block("ex", {a}, level, false);
+            }
+    };
+}
+
+SchemeFile Generator::chain(size_t length, unsigned long long seed)
+{
+    // every ln follows ex and every sqrt follows ln of ex, the values stay small
+    static const char* cycle[] = {"abs", "ex", "ln", "sqrt", "neg", "sign", "squared"};
+    const size_t n = sizeof(cycle) / sizeof(cycle[0]);
+    Builder b(seed);
+    long last = b.input(0);
+    size_t start = b.below(n);
+    for(size_t i = 0; i < length; i++)
+    {
+        // the operands of ln and sqrt are already positive, unless the chain starts there
+        last = b.block(cycle[(start + i) % n], {last}, i + 1, i < 3);
+    }
+    return b.getFile();
+}
+
+SchemeFile Generator::tree(size_t leaves, size_t fanin, unsigned long long seed)
+{
+    static const char* reducers[] = {"sum", "product", "min", "max"};
+    Builder b(seed);
+    fanin = std::max<size_t>(fanin, 2);
+    std::vector<long> level;
+    for(size_t i = 0; i < std::max<size_t>(leaves, 1); i++) level.push_back(b.input(0));
+    for(size_t l = 1; level.size() > 1; l++)
+    {
+        std::vector<long> next;
+        for(size_t i = 0; i < level.size(); i += fanin)
+        {
+            std::vector<long> group(level.begin() + i, level.begin() + std::min(i + fanin, level.size()));
+            if(group.size() == 1) next.push_back(group[0]);
+            else next.push_back(b.block(reducers[b.below(4)], group, l));
+        }
+        level = next;
+    }
+    return b.getFile();
+}
+
+SchemeFile Generator::dag(size_t depth, size_t width, unsigned long long seed)
+{
+    std::vector<std::string> names;
+    for(auto& it: Config::getBlockNames()) names.push_back(it.first);
+
+    Builder b(seed);
+    width = std::max<size_t>(width, 1);
+    std::vector<long> all, above;
+    for(size_t i = 0; i < width; i++) above.push_back(b.input(0));
+    all = above;
+    for(size_t l = 1; l <= depth; l++)
+    {
+        std::vector<long> current;
+        for(size_t i = 0; i < width; i++)
+        {
+            const std::string& name = names[b.below(names.size())];
+            size_t n = Builder::arity(name);
+            if(n == 0) n = 2 + b.below(3);
+            std::vector<long> sources{above[b.below(above.size())]};
+            while(sources.size() < n) sources.push_back(all[b.below(all.size())]);
+            current.push_back(b.block(name, sources, l));
+        }
+        all.insert(all.end(), current.begin(), current.end());
+        above = current;
+    }
+    return b.getFile();
+}
+
+SchemeFile Generator::mix(size_t blocks, unsigned long long seed)
+{
+    std::vector<std::string> names;
+    for(auto& it: Config::getBlockNames()) names.push_back(it.first);
+
+    Builder b(seed);
+    std::vector<long> all;
+    for(size_t i = 0; i < 8; i++) all.push_back(b.input(0));
+    for(size_t i = 0; i < blocks; i++)
+    {
+        const std::string& name = names[i % names.size()];
+        size_t n = Builder::arity(name);
+        if(n == 0) n = 2 + b.below(3);
+        std::vector<long> sources;
+        while(sources.size() < n) sources.push_back(all[b.below(all.size())]);
+        all.push_back(b.block(name, sources, 1 + i / 16));
+    }
+    return b.getFile();
+}
@@ -0,0 +1,59 @@
+/**
+ * @file generator.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief synthetic scheme generator interface
+ *
+ * This module makes the schemes of the given shape and size for the
+ * benchmarks. The same seed gives always the same scheme. The operands
+ * of ln, sqrt and of the denominator of the divider are made positive
+ * (ex of abs), so the evaluation never fails on the math error.
+ * Config::initConfig() must be called before.
+ */
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <cstddef>
+
+#include "scheme.h"
+
+/**
+ * @brief Namespace of the generators.
+ */
+namespace Generator
+{
+    /**
+     * @brief Long chain of the blocks with one input.
+     * @param length    Count of the blocks.
+     * @param seed      Seed.
+     * @returns Scheme.
+     */
+    SchemeFile chain(size_t length, unsigned long long seed);
+    /**
+     * @brief Tree reducing the inputs by the blocks with N inputs.
+     * @param leaves    Count of the inputs.
+     * @param fanin     Inputs of every block (at least 2).
+     * @param seed      Seed.
+     * @returns Scheme.
+     */
+    SchemeFile tree(size_t leaves, size_t fanin, unsigned long long seed);
+    /**
+     * @brief Random acyclic graph by levels. Every block has the input
+     *        from the level right above it, the others from any level above.
+     * @param depth     Count of the levels of the blocks.
+     * @param width     Count of the blocks (and the inputs) in the level.
+     * @param seed      Seed.
+     * @returns Scheme.
+     */
+    SchemeFile dag(size_t depth, size_t width, unsigned long long seed);
+    /**
+     * @brief Blocks of all the types of Config in turn, wired randomly.
+     * @param blocks    Count of the blocks.
+     * @param seed      Seed.
+     * @returns Scheme.
+     */
+    SchemeFile mix(size_t blocks, unsigned long long seed);
+}
+
+#endif // GENERATOR_H
@@ -0,0 +1,155 @@
+/**
+ * @file analysis.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief analysis of the scheme module
+ *
+ * This module contains the critical path and the parallelism analysis.
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "analysis.h"
+#include "config.h"
+#include "debug.h"
+
+namespace {
+    /** @brief Estimated costs of the built-in blocks (the addition is 1). */
+    const std::map<std::string,double> Estimates = {
+        {"adder", 1}, {"subtractor", 1}, {"multiplier", 1}, {"divider", 4},
+        {"ex", 20}, {"abs", 1}, {"ln", 20}, {"neg", 1}, {"sign", 1}, {"squared", 1}, {"sqrt", 6},
+        {"sum", 1}, {"product", 1}, {"min", 1}, {"max", 1}
+    };
+
+    /**
+     * @brief Unit of the costs.
+     * @param measured  Costs are measured.
+     * @returns Name of the unit.
+     */
+    const char* getUnit(bool measured) { return measured ? "ns" : "units"; }
+}
+
+size_t SchemeAnalysis::getMaxWidth() const
+{
+    // level 0 are the inputs
+    size_t w = 0;
+    for(size_t i = 1; i < widths.size(); i++) w = std::max(w, widths[i]);
+    return w;
+}
+
+std::string SchemeAnalysis::getSummary() const
+{
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(1);
+    os << "Blocks: " << blocks << " in " << ((widths.size() > 0) ? widths.size() - 1 : 0)
+       << " levels, the widest level has " << getMaxWidth() << " blocks\n";
+    os << "Work: " << work << " " << getUnit(measured) << ", critical path: " << span << " "
+       << getUnit(measured) << " (" << ((path.size() > 0) ? path.size() - 1 : 0) << " blocks)\n";
+    os << std::setprecision(2) << "Speedup bound: " << getSpeedup() << " (unlimited cores), " << getLevelSpeedup()
+       << " (level by level)\n";
+    if(!measured) os << "The costs are estimated, profile the blocks to measure them.\n";
+    return os.str();
+}
+
+std::string SchemeAnalysis::getDetails() const
+{
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(1);
+    os << "level,blocks,cost\n";
+    for(size_t i = 0; i < widths.size(); i++) os << i << "," << widths[i] << "," << levelcosts[i] << "\n";
+    os << "\ncritical path\nblock,cost,total\n";
+    double total = 0;
+    for(size_t i = 0; i < path.size(); i++)
+    {
+        total += pathcosts[i];
+        os << path[i] << "," << pathcosts[i] << "," << total << "\n";
+    }
+    return os.str();
+}
+
+double Analysis::estimate(long type, size_t inputs)
+{
+    std::string name;
+    try { name = Config::getBlockName(type); }
+    catch(MyError&) { return 1; }
+    auto it = Estimates.find(name);
+    double c = (it != Estimates.end()) ? it->second : 1;
+    // the reductions pay for every input
+    if(Config::decodeBlockType(type) == BlockType::NIn_OneOut) c *= double(std::max<size_t>(inputs, 1));
+    return c;
+}
+
+SchemeAnalysis Analysis::analyze(const Plan& p, const std::map<long,BlockCost>& profile)
+{
+    Debug::Span span(Debug::TraceCompute, "Analysis::analyze()");
+    SchemeAnalysis a;
+    const std::vector<PlanNode>& nodes = p.getNodes();
+
+    // mean measured cost of the types, the scale of the estimates to the measured costs
+    std::map<long,std::pair<double,size_t>> types;
+    double measured = 0, estimated = 0;
+    for(auto& n: nodes)
+    {
+        auto it = profile.find(n.id);
+        if(it == profile.end() || it->second.calls == 0) continue;
+        double c = it->second.getNsPerCall();
+        types[n.type].first += c;
+        types[n.type].second++;
+        measured += c;
+        estimated += estimate(n.type, n.in.size());
+        a.measured = true;
+    }
+    const double scale = (estimated > 0) ? measured / estimated : 1;
+
+    // longest path ending at every slot, the inputs end at zero
+    const size_t slots = p.getSlotCount();
+    std::vector<double> cost(slots, 0), finish(slots, 0);
+    std::vector<long> from(slots, -1), owner(slots, -1);
+    for(size_t i = 0; i < p.getInputs().size(); i++) owner[p.getInputSlots()[i]] = p.getInputs()[i];
+    a.widths.assign(1, p.getInputs().size());
+    a.levelcosts.assign(1, 0);
+    std::vector<double> dearest(1, 0);
+    long end = -1;
+    for(auto& n: nodes)
+    {
+        auto it = profile.find(n.id);
+        double c;
+        if(it != profile.end() && it->second.calls > 0) c = it->second.getNsPerCall();
+        else if(types.count(n.type) > 0) c = types.at(n.type).first / double(types.at(n.type).second);
+        else c = estimate(n.type, n.in.size()) * scale;
+
+        const long s = n.out;
+        owner[s] = n.id;
+        cost[s] = c;
+        for(auto& in: n.in) { if(from[s] < 0 || finish[in] > finish[from[s]]) from[s] = in; }
+        finish[s] = c + ((from[s] >= 0) ? finish[from[s]] : 0);
+        if(end < 0 || finish[s] > finish[end]) end = s;
+
+        const size_t level = size_t(std::max(n.level, 0));
+        if(a.widths.size() <= level)
+        {
+            a.widths.resize(level + 1, 0);
+            a.levelcosts.resize(level + 1, 0);
+            dearest.resize(level + 1, 0);
+        }
+        a.widths[level]++;
+        a.levelcosts[level] += c;
+        dearest[level] = std::max(dearest[level], c);
+        a.work += c;
+        a.blocks++;
+    }
+    for(auto& it: dearest) a.levelspan += it;
+
+    if(end >= 0) a.span = finish[end];
+    for(long s = end; s >= 0; s = from[s])
+    {
+        a.path.push_back(owner[s]);
+        a.pathcosts.push_back(cost[s]);
+    }
+    std::reverse(a.path.begin(), a.path.end());
+    std::reverse(a.pathcosts.begin(), a.pathcosts.end());
+    Debug::Compute("Analysis::analyze(blocks, path)", a.blocks, a.path.size());
+    return a;
+}
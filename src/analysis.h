@@ -0,0 +1,91 @@
+/**
+ * @file analysis.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief analysis of the scheme interface
+ *
+ * This module analyses the dependencies of the scheme. It finds the
+ * critical path (the chain of the blocks with the largest sum of the costs),
+ * the width of every level and the bound of the speedup of the parallel
+ * evaluation. The costs are measured by the profiling of the blocks, the
+ * blocks not measured are estimated by their type.
+ */
+
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "defs.h"
+#include "plan.h"
+
+/**
+ * @brief Result of the analysis.
+ */
+struct SchemeAnalysis {
+    std::vector<long> path; /**< Blocks of the critical path, from its input to the end. */
+    std::vector<double> pathcosts; /**< Costs of the blocks of the critical path. */
+    std::vector<long> wires; /**< Wires of the critical path. */
+    std::vector<size_t> widths; /**< Count of the blocks of every level (inputs are level 0). */
+    std::vector<double> levelcosts; /**< Costs of the blocks of every level. */
+    size_t blocks = 0; /**< Count of the evaluated blocks (not inputs). */
+    double work = 0; /**< Cost of all the blocks. */
+    double span = 0; /**< Cost of the critical path. */
+    double levelspan = 0; /**< Sum of the costs of the dearest block of every level. */
+    bool measured = false; /**< Costs are in nanoseconds (estimated units otherwise). */
+
+    /**
+     * @brief Speedup bound with unlimited cores (work / critical path).
+     * @returns Speedup.
+     */
+    double getSpeedup() const { return (span > 0) ? work / span : 1; }
+    /**
+     * @brief Speedup bound of the evaluation level by level, where every level
+     *        waits for its dearest block.
+     * @returns Speedup.
+     */
+    double getLevelSpeedup() const { return (levelspan > 0) ? work / levelspan : 1; }
+    /**
+     * @brief Width of the widest level of the blocks.
+     * @returns Count of the blocks.
+     */
+    size_t getMaxWidth() const;
+    /**
+     * @brief Summary (the work, the critical path and the speedup).
+     * @returns Text.
+     */
+    std::string getSummary() const;
+    /**
+     * @brief Details (the levels and the blocks of the critical path).
+     * @returns Text.
+     */
+    std::string getDetails() const;
+};
+
+/**
+ * @brief Analysis namespace.
+ */
+namespace Analysis
+{
+    /**
+     * @brief Estimated cost of the block, relative to the addition.
+     * @param type      Type of the block.
+     * @param inputs    Count of the inputs.
+     * @returns Cost.
+     */
+    double estimate(long type, size_t inputs);
+    /**
+     * @brief Analyses the plan. The plan must not be optimized, so its nodes
+     *        are the blocks of the scheme. The blocks without the measured cost
+     *        take the mean cost of their type, or the estimate scaled to the
+     *        measured blocks.
+     * @param p         Plan (not optimized).
+     * @param profile   Measured costs of the blocks.
+     * @returns Analysis (without the wires).
+     */
+    SchemeAnalysis analyze(const Plan& p, const std::map<long,BlockCost>& profile);
+}
+
+#endif // ANALYSIS_H
@@ -0,0 +1,297 @@
+/**
+ * @file autodiff.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief automatic differentiation module
+ *
+ * This module contains the automatic differentiation implementation.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "autodiff.h"
+#include "debug.h"
+#include "defs.h"
+
+namespace {
+    /**
+     * @brief Operand count of the instruction.
+     * @param ins       Instruction.
+     * @returns Count of the operands.
+     */
+    unsigned arity(const Instruction& ins)
+    {
+        if(ins.op >= OpSum && ins.op <= OpMax) return ins.b;
+        return (ins.op <= OpDiv) ? 2 : 1;
+    }
+
+    /**
+     * @brief Operand register of the instruction.
+     * @param ins       Instruction.
+     * @param operands  Operands of the reductions.
+     * @param i         Index of the operand.
+     * @returns Register.
+     */
+    unsigned operand(const Instruction& ins, const std::vector<unsigned>& operands, unsigned i)
+    {
+        if(ins.op >= OpSum && ins.op <= OpMax) return operands[ins.a + i];
+        return (i == 0) ? ins.a : ins.b;
+    }
+
+    /**
+     * @brief Evaluates the instruction and its derivatives by the operands.
+     *        The derivatives of the erroneous value are NaN.
+     * @param ins       Instruction.
+     * @param operands  Operands of the reductions.
+     * @param r         Register file.
+     * @param e         Errors of the registers.
+     * @param args      Buffer for the arguments of the reduction.
+     * @param d         Derivatives by the operands (arity(ins) values).
+     */
+    void step(const Instruction& ins, const std::vector<unsigned>& operands,
+              double* r, unsigned char* e, double* args, double* d)
+    {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        unsigned n = arity(ins);
+        bool poisoned = false;
+        for(unsigned i = 0; i < n; i++)
+        {
+            unsigned reg = operand(ins, operands, i);
+            poisoned = poisoned || e[reg] != EvalError::EvalOk;
+            args[i] = r[reg];
+        }
+        if(poisoned)
+        {
+            std::fill(d, d + n, nan);
+            r[ins.dst] = nan;
+            // the link of the fused chain (in place) keeps the error of the failed link
+            if(n != 1 || operand(ins, operands, 0) != ins.dst) e[ins.dst] = EvalError::Poisoned;
+            return;
+        }
+
+        EvalError err = EvalError::EvalOk;
+        double x = args[0], y = (n > 1) ? args[1] : 0;
+        double v = Program::apply(ins.op, x, y, args, n, err);
+        switch(ins.op)
+        {
+            case OpAdd: d[0] = 1; d[1] = 1; break;
+            case OpSub: d[0] = 1; d[1] = -1; break;
+            case OpMul: d[0] = y; d[1] = x; break;
+            case OpDiv: d[0] = 1 / y; d[1] = -x / (y * y); break;
+            case OpExp: d[0] = v; break;
+            case OpAbs:
+            case OpSqrtOfSquared: d[0] = (x < 0) ? -1 : 1; break;
+            case OpLog: d[0] = 1 / x; break;
+            case OpNeg: d[0] = -1; break;
+            case OpSign: d[0] = 0; break;
+            case OpSquare: d[0] = 2 * x; break;
+            case OpSqrt: d[0] = 0.5 / v; break;
+            case OpLogOfExp: d[0] = 1; break;
+            case OpSum: std::fill(d, d + n, 1.0); break;
+            case OpProduct:
+            {
+                // products of the others, by the prefixes and the suffixes
+                double p = 1;
+                for(unsigned i = 0; i < n; i++) { d[i] = p; p *= args[i]; }
+                p = 1;
+                for(unsigned i = n; i-- > 0;) { d[i] *= p; p *= args[i]; }
+                break;
+            }
+            case OpMin:
+            case OpMax:
+            {
+                // the first operand equal to the result
+                bool found = false;
+                for(unsigned i = 0; i < n; i++)
+                {
+                    d[i] = (!found && args[i] == v) ? 1 : 0;
+                    found = found || d[i] != 0;
+                }
+                break;
+            }
+            case OpCount: break;
+        }
+        if(err != EvalError::EvalOk) std::fill(d, d + n, nan);
+        r[ins.dst] = v;
+        e[ins.dst] = err;
+    }
+}
+
+ForwardDiff::ForwardDiff(const Program& p, const std::vector<long>& wrt):
+    mprogram(p), mwrt(wrt)
+{
+    Debug::Compute("ForwardDiff::ForwardDiff()");
+    const std::vector<long>& inputs = mprogram.getInputs();
+    for(auto& it: mwrt)
+    {
+        auto i = std::find(inputs.begin(), inputs.end(), it);
+        if(i == inputs.end())
+            throw MyError("Block "+std::to_string(it)+" is not a variable input", ErrorType::BlockError);
+        mlanes.push_back(unsigned(i - inputs.begin()));
+    }
+
+    size_t args = 1;
+    for(auto& it: mprogram.getCode()) { args = std::max(args, size_t(arity(it))); }
+    size_t n = mprogram.getRegisterCount();
+    mregs.assign(n, 0);
+    merrs.assign(n, EvalError::EvalOk);
+    mtangents.assign(n * mwrt.size(), 0);
+    margs.resize(args);
+    mpartials.resize(args);
+}
+
+void ForwardDiff::run(const double* inputs, double* outputs, double* derivatives, EvalError* errors)
+{
+    const size_t k = mwrt.size();
+    double* r = mregs.data();
+    unsigned char* e = merrs.data();
+    double* t = mtangents.data();
+    const std::vector<unsigned>& inregs = mprogram.getInputRegisters();
+    const std::vector<unsigned>& operands = mprogram.getOperands();
+
+    // seeds, the constants have no derivatives
+    std::fill(mtangents.begin(), mtangents.end(), 0.0);
+    for(size_t i = 0; i < inregs.size(); i++)
+    {
+        r[inregs[i]] = inputs[i];
+        e[inregs[i]] = EvalError::EvalOk;
+    }
+    for(size_t j = 0; j < k; j++) t[inregs[mlanes[j]]*k + j] = 1;
+    for(auto& it: mprogram.getConstants())
+    {
+        r[it.slot] = it.value;
+        e[it.slot] = it.error;
+    }
+
+    for(auto& ins: mprogram.getCode())
+    {
+        unsigned n = arity(ins);
+        step(ins, operands, r, e, margs.data(), mpartials.data());
+        // the fused links write in place, so the lane is read before it is written
+        double* dst = t + size_t(ins.dst)*k;
+        for(size_t j = 0; j < k; j++)
+        {
+            double s = 0;
+            for(unsigned i = 0; i < n; i++)
+            {
+                double ti = t[size_t(operand(ins, operands, i))*k + j];
+                if(ti != 0 || std::isnan(mpartials[i])) s += mpartials[i] * ti;
+            }
+            dst[j] = s;
+        }
+    }
+
+    const std::vector<unsigned>& outregs = mprogram.getOutputRegisters();
+    for(size_t i = 0; i < outregs.size(); i++)
+    {
+        outputs[i] = r[outregs[i]];
+        if(errors != nullptr) errors[i] = EvalError(e[outregs[i]]);
+        std::copy(t + size_t(outregs[i])*k, t + size_t(outregs[i]+1)*k, derivatives + i*k);
+    }
+}
+
+void ForwardDiff::evaluate(const std::vector<double>& inputs, size_t rows,
+                           std::vector<double>& outputs, std::vector<double>& derivatives,
+                           std::vector<EvalError>* errors)
+{
+    Debug::Compute("ForwardDiff::evaluate()", rows);
+    const size_t ni = mprogram.getInputs().size(), no = mprogram.getOutputs().size(), k = mwrt.size();
+    if(inputs.size() != ni * rows) throw MyError("Wrong count of the input values", ErrorType::BlockError);
+    outputs.resize(no * rows);
+    derivatives.resize(no * k * rows);
+    if(errors != nullptr) errors->resize(no * rows);
+    mrow.resize(ni);
+    mrowout.resize(no);
+    mrowder.resize(no * k);
+    mrowerr.resize(no);
+
+    for(size_t row = 0; row < rows; row++)
+    {
+        for(size_t i = 0; i < ni; i++) mrow[i] = inputs[i*rows + row];
+        run(mrow.data(), mrowout.data(), mrowder.data(), mrowerr.data());
+        for(size_t o = 0; o < no; o++)
+        {
+            outputs[o*rows + row] = mrowout[o];
+            if(errors != nullptr) (*errors)[o*rows + row] = mrowerr[o];
+            for(size_t j = 0; j < k; j++) derivatives[(o*k + j)*rows + row] = mrowder[o*k + j];
+        }
+    }
+}
+
+ReverseDiff::ReverseDiff(const Program& p):
+    mprogram(p)
+{
+    Debug::Compute("ReverseDiff::ReverseDiff()");
+    size_t size = 0, args = 1;
+    for(auto& it: mprogram.getCode())
+    {
+        moffsets.push_back(size);
+        size += arity(it);
+        args = std::max(args, size_t(arity(it)));
+    }
+    size_t n = mprogram.getRegisterCount();
+    mtape.assign(size, 0);
+    mregs.assign(n, 0);
+    merrs.assign(n, EvalError::EvalOk);
+    madjoints.assign(n, 0);
+    margs.resize(args);
+}
+
+void ReverseDiff::run(const double* inputs, double* outputs, EvalError* errors)
+{
+    double* r = mregs.data();
+    unsigned char* e = merrs.data();
+    const std::vector<unsigned>& inregs = mprogram.getInputRegisters();
+    const std::vector<unsigned>& operands = mprogram.getOperands();
+    const std::vector<Instruction>& code = mprogram.getCode();
+
+    for(size_t i = 0; i < inregs.size(); i++)
+    {
+        r[inregs[i]] = inputs[i];
+        e[inregs[i]] = EvalError::EvalOk;
+    }
+    for(auto& it: mprogram.getConstants())
+    {
+        r[it.slot] = it.value;
+        e[it.slot] = it.error;
+    }
+    for(size_t i = 0; i < code.size(); i++)
+        step(code[i], operands, r, e, margs.data(), mtape.data() + moffsets[i]);
+
+    const std::vector<unsigned>& outregs = mprogram.getOutputRegisters();
+    for(size_t i = 0; i < outregs.size(); i++)
+    {
+        outputs[i] = r[outregs[i]];
+        if(errors != nullptr) errors[i] = EvalError(e[outregs[i]]);
+    }
+}
+
+void ReverseDiff::gradient(long output, double* gradient)
+{
+    const std::vector<long>& outputs = mprogram.getOutputs();
+    auto it = std::find(outputs.begin(), outputs.end(), output);
+    if(it == outputs.end())
+        throw MyError("Block "+std::to_string(output)+" is not an output", ErrorType::BlockError);
+
+    const std::vector<unsigned>& operands = mprogram.getOperands();
+    const std::vector<Instruction>& code = mprogram.getCode();
+    double* adj = madjoints.data();
+    std::fill(madjoints.begin(), madjoints.end(), 0.0);
+    adj[mprogram.getOutputRegisters()[it - outputs.begin()]] = 1;
+
+    for(size_t i = code.size(); i-- > 0;)
+    {
+        const Instruction& ins = code[i];
+        // the fused links write in place, so the adjoint is taken before it is passed on
+        double a = adj[ins.dst];
+        if(a == 0) continue;
+        adj[ins.dst] = 0;
+        const double* d = mtape.data() + moffsets[i];
+        for(unsigned k = 0; k < arity(ins); k++) adj[operand(ins, operands, k)] += a * d[k];
+    }
+
+    const std::vector<unsigned>& inregs = mprogram.getInputRegisters();
+    for(size_t i = 0; i < inregs.size(); i++) gradient[i] = adj[inregs[i]];
+}
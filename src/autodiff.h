@@ -0,0 +1,145 @@
+/**
+ * @file autodiff.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief automatic differentiation interface
+ *
+ * This module differentiates the compiled scheme. The forward mode
+ * evaluates the program over dual numbers, every register carries its
+ * value and the derivatives by the selected inputs (lanes), so one pass
+ * gives the values together with the columns of the Jacobian. The reverse
+ * mode records the local derivatives of every instruction on a tape during
+ * the evaluation and sweeps the instructions backwards, so one pass gives
+ * the gradient of one output by all the inputs.
+ */
+
+#ifndef AUTODIFF_H
+#define AUTODIFF_H
+
+#include <vector>
+
+#include "program.h"
+
+/**
+ * @brief Forward mode differentiation of the program.
+ */
+class ForwardDiff
+{
+    public:
+        /**
+         * @brief ForwardDiff constructor.
+         * @param p         Compiled program.
+         * @param wrt       IDs of the inputs to differentiate by (one lane each).
+         */
+        ForwardDiff(const Program& p, const std::vector<long>& wrt);
+
+        /**
+         * @brief Evaluates the values and the derivatives. Uses the preallocated
+         *        registers, so it does not allocate. The derivatives at the erroneous
+         *        values are NaN, the functions with no derivative in the point (abs
+         *        and sign in zero, ties of min and max) take the one-sided one.
+         * @param inputs        Values of the inputs, in the order of getProgram().getInputs().
+         * @param outputs       Values of the outputs, in the order of getProgram().getOutputs().
+         * @param derivatives   Derivatives of the outputs, output after output, getLanes() each.
+         * @param errors        Errors of the outputs (may be nullptr).
+         */
+        void run(const double* inputs, double* outputs, double* derivatives, EvalError* errors = nullptr);
+        /**
+         * @brief Evaluates the batch of rows (see run).
+         * @param inputs        Input values, column after column (each has rows values).
+         * @param rows          Count of the rows.
+         * @param outputs       Output values, column after column (resized).
+         * @param derivatives   Derivatives, output after output, lane after lane, each
+         *                      has rows values (resized).
+         * @param errors        Errors of the outputs, same layout as outputs (may be nullptr).
+         */
+        void evaluate(const std::vector<double>& inputs, size_t rows,
+                      std::vector<double>& outputs, std::vector<double>& derivatives,
+                      std::vector<EvalError>* errors = nullptr);
+
+        /**
+         * @brief Lane count getter.
+         * @returns Count of the inputs differentiated by.
+         */
+        size_t getLanes() const { return mwrt.size(); }
+        /**
+         * @brief Lanes getter.
+         * @returns IDs of the inputs differentiated by.
+         */
+        const std::vector<long>& getWrt() const { return mwrt; }
+        /**
+         * @brief Program getter.
+         * @returns Program.
+         */
+        const Program& getProgram() const { return mprogram; }
+
+    private:
+        Program mprogram; /**< Program. */
+        std::vector<long> mwrt; /**< IDs of the lanes. */
+        std::vector<unsigned> mlanes; /**< Index of the input of each lane. */
+
+        std::vector<double> mregs; /**< Register file. */
+        std::vector<unsigned char> merrs; /**< Errors of the registers. */
+        std::vector<double> mtangents; /**< Derivatives of the registers, getLanes() each. */
+        std::vector<double> margs; /**< Arguments of the reduction. */
+        std::vector<double> mpartials; /**< Local derivatives of the instruction. */
+        std::vector<double> mrow; /**< Inputs of the row (batch). */
+        std::vector<double> mrowout; /**< Outputs of the row (batch). */
+        std::vector<double> mrowder; /**< Derivatives of the row (batch). */
+        std::vector<EvalError> mrowerr; /**< Errors of the row (batch). */
+};
+
+/**
+ * @brief Reverse mode differentiation of the program. The instructions are
+ *        in the order of the levels, the sweep goes backwards through it.
+ */
+class ReverseDiff
+{
+    public:
+        /**
+         * @brief ReverseDiff constructor. Allocates the tape, its size is the
+         *        count of the operands of all the instructions.
+         * @param p         Compiled program.
+         */
+        ReverseDiff(const Program& p);
+
+        /**
+         * @brief Evaluates the program and records the tape (see Program::run).
+         *        The tape is overwritten by every run, nothing is allocated.
+         * @param inputs    Values of the inputs, in the order of getProgram().getInputs().
+         * @param outputs   Values of the outputs, in the order of getProgram().getOutputs().
+         * @param errors    Errors of the outputs (may be nullptr).
+         */
+        void run(const double* inputs, double* outputs, EvalError* errors = nullptr);
+        /**
+         * @brief Sweeps the tape of the last run. The derivatives by the inputs
+         *        the output does not depend on are zero, the derivatives through
+         *        the erroneous values are NaN.
+         * @param output    ID of the output block.
+         * @param gradient  Derivatives by the inputs, in the order of getProgram().getInputs().
+         */
+        void gradient(long output, double* gradient);
+
+        /**
+         * @brief Tape size getter.
+         * @returns Count of the recorded derivatives.
+         */
+        size_t getTapeSize() const { return mtape.size(); }
+        /**
+         * @brief Program getter.
+         * @returns Program.
+         */
+        const Program& getProgram() const { return mprogram; }
+
+    private:
+        Program mprogram; /**< Program. */
+        std::vector<size_t> moffsets; /**< Offset of each instruction on the tape. */
+        std::vector<double> mtape; /**< Local derivatives by the operands. */
+
+        std::vector<double> mregs; /**< Register file. */
+        std::vector<unsigned char> merrs; /**< Errors of the registers. */
+        std::vector<double> madjoints; /**< Derivatives of the output by the registers. */
+        std::vector<double> margs; /**< Arguments of the reduction. */
+};
+
+#endif // AUTODIFF_H
@@ -18,9 +18,11 @@
 #include <string>
 #include <vector>
 
+#include "config.h"
 #include "debug.h"
 #include "defs.h"
 #include "iblock.h"
+#include "profile.h"
 #include "wire.h"
 
 /**
@@ -31,10 +33,12 @@ class Input: public IBlock
     public:
         /**
          * @brief Input constructor
+         * @param id        ID of the block.
          * @param value     Initial value of constructor.
+         * @param store     Value storage of the scheme.
          */
-        Input(long id, Value value):
-            IBlock(id), mO(value.type)
+        Input(long id, Value value, ValueStore& store):
+            IBlock(id, store), mO(value.type)
         {
             Debug::Block("Input::Input");
             setValue(value);
@@ -49,7 +53,7 @@ class Input: public IBlock
         void addWire(Wire* w, long key, int port = 0) override
         {
             Debug::Block("Input::addWire()");
-            mO.wire = w;
+            mO.connect(w);
             std::set<int> s;
             propagateLevel(0, s);
             IBlock::addWire(w, key, port);
@@ -61,7 +65,7 @@ class Input: public IBlock
         void removeWireKey(long key) override
         {
             Debug::Block("Input::removeWireKey()");
-            mO.wire = nullptr;
+            mO.disconnect(key);
             IBlock::removeWireKey(key);
         }
 
@@ -81,6 +85,16 @@ class Input: public IBlock
          * @returns True, if input.
          */
         bool isInput() override { return true; }
+        /**
+         * @brief Constant indicator.
+         * @returns True, if the input is marked constant.
+         */
+        bool isConstant() const override { return mconstant; }
+        /**
+         * @brief Marks the input as constant or variable.
+         * @param c         True, if constant.
+         */
+        void setConstant(bool c) override { mconstant = c; }
 
         /**
          * @brief Initializes distributed computation in the scheme.
@@ -88,7 +102,7 @@ class Input: public IBlock
          */
         SimulationResults distributeResult() override
         {
-            Debug::Block("Input::distributeResult() = "+std::to_string(getId()));
+            Debug::Block("Input::distributeResult()", getId());
             // compute
             SimulationResults sr;
             Result r;
@@ -113,8 +127,20 @@ class Input: public IBlock
             mO.propagateLevel(0, s);
         }
 
+        /**
+         * @brief Adds the memory of the input to the report.
+         * @param r         Report.
+         */
+        void accountMemory(MemoryReport& r) const override
+        {
+            r.addShared("IBlock", sizeof(*this));
+            IBlock::accountMemory(r);
+            mO.accountMemory(r);
+        }
+
     private:
-        Port mO; /**< Output wire. */
+        Port mO; /**< Output port. */
+        bool mconstant = false; /**< Value does not change between runs. */
 };
 
 /**
@@ -126,13 +152,15 @@ class Block: public IBlock
     public:
         /**
          * @brief Block constructor.
+         * @param id        ID of the block.
+         * @param store     Value storage of the scheme.
          * @param func      Functionality of the block (lambdas as templates).
          * @param intypes   Types of inputs.
          * @param outtypes  Types of input.
          * @param type_o    Type of the output.
          */
-        Block(long id, T func, std::vector<std::string> intypes, std::vector<std::string> outtypes, long type):
-            IBlock(id, type), mfunc(func)
+        Block(long id, ValueStore& store, T func, std::vector<std::string> intypes, std::vector<std::string> outtypes, long type):
+            IBlock(id, store, type), mfunc(func)
         {
             for(auto& it: intypes) { mIn.push_back(std::make_shared<Port>(it)); }
             for(auto& it: outtypes) { mOut.push_back(std::make_shared<Port>(it)); }
@@ -154,6 +182,37 @@ class Block: public IBlock
 
         inline void removeWireKey(long) override;
 
+        /**
+         * @brief Input port count getter.
+         * @returns Count of the input ports.
+         */
+        int getInputCount() const override { return int(mIn.size()); }
+        /**
+         * @brief Getter of the slots, the block reads its inputs from.
+         * @returns Slots of the input ports (-1 for unconnected port).
+         */
+        std::vector<long> getInputSlots() const override
+        {
+            std::vector<long> v;
+            for(auto& it: mIn) { v.push_back(it->slot); }
+            return v;
+        }
+
+        /**
+         * @brief Adds the memory of the block and its ports to the report.
+         * @param r         Report.
+         */
+        void accountMemory(MemoryReport& r) const override
+        {
+            r.addShared("IBlock", sizeof(*this));
+            IBlock::accountMemory(r);
+            r.addVector("vectors", mIn);
+            r.addVector("vectors", mOut);
+            r.addVector("vectors", margs);
+            for(auto& it: mIn) { r.addShared("Port", sizeof(Port)); it->accountMemory(r); }
+            for(auto& it: mOut) { r.addShared("Port", sizeof(Port)); it->accountMemory(r); }
+        }
+
         /**
          * @brief Distributes the results. Compute itself.
          * @param sr        Previous results.
@@ -162,11 +221,21 @@ class Block: public IBlock
         SimulationResults& distributeResult(SimulationResults& sr) override 
         {
             // control, if all previous have been counted
-            for(auto& it: mIn) { if(!it->getValue().valid) { return sr; } }
-            Debug::Block("Block::distributeResult() = " + std::to_string(getId()));
+            for(auto& it: mIn) { if(it->slot < 0 || !getStore().isValid(it->slot)) { return sr; } }
+            // already counted (reached through another wire of a fan-out)
+            if(getStore().isValid(getSlot())) { return sr; }
+            Debug::Block("Block::distributeResult()", getId());
             // compute value
             Result r;
-            Compute();
+            {
+                Debug::Span span(Debug::TraceBlock, "Block::Compute()", getId(), getLevel());
+                Compute();
+            }
+            if(ComputeProgress* p = getStore().getProgress())
+            {
+                p->done++;
+                if(p->isCancelled()) throw MyError("Computation cancelled", ErrorType::Cancelled);
+            }
             Value v = getValue();
             r.value = v.value;
             r.type = v.type;
@@ -188,6 +257,7 @@ class Block: public IBlock
 
         std::vector<std::shared_ptr<Port>> mIn; /**< Input ports. */
         std::vector<std::shared_ptr<Port>> mOut; /**< Output ports */
+        std::vector<double> margs; /**< Gathered inputs (blocks with N inputs). */
 
         /**
          * @brief Checks, weather the types are correct.
@@ -201,20 +271,20 @@ class Block: public IBlock
         void Compute();
         /**
          * @brief Template computation (dependent on template variable T).
+         *        Stores the result into the slot of the block.
          * @param f         Function to call.
-         * @returns Result of computation.
          */
-        Value Compute(T) { throw MyError("Not implemented computation.", ErrorType::MathError); }
+        void Compute(T) { throw MyError("Not implemented computation.", ErrorType::MathError); }
 
 };
 
 template <class T>
 void Block<T>::removeWireKey(long id)
 {
-    Debug::Block("Block::removeWireKey("+std::to_string(id)+")"); 
+    Debug::Block("Block::removeWireKey()", id);
     if(getWireKeys().count(id) == 0) return;
-    if(getWireKeys().at(id) < 0) mOut.at(-getWireKeys().at(id)-1)->disconnect();
-    else mIn.at(getWireKeys().at(id))->disconnect();
+    if(getWireKeys().at(id) < 0) mOut.at(-getWireKeys().at(id)-1)->disconnect(id);
+    else mIn.at(getWireKeys().at(id))->disconnect(id);
 
     IBlock::removeWireKey(id);
 }
@@ -226,10 +296,11 @@ void Block<T>::addWire(Wire *w, long key, int port)
     std::vector<std::shared_ptr<Port>>& v = (port < 0)?mOut:mIn;
     int index = (port < 0) ? (-port-1):(port);
 
+    // already connected input port (outputs fan out)
+    if(isInputPort(port) && v.at(index)->isConnected())
+        throw MyError("Adding wire to connected port", ErrorType::WireError);
     // connect wire
-    if(v.at(index)->wire == nullptr) v.at(index)->wire = w;
-    // already connected port
-    else throw MyError("Adding wire to connected port", ErrorType::WireError);
+    v.at(index)->connect(w);
 
     // add to keys
     IBlock::addWire(w, key, port);
@@ -255,7 +326,7 @@ void Block<T>::addWire(Wire *w, long key, int port)
 template <class T>
 void Block<T>::propagateLevel(int level, std::set<int> prop)
 {
-    Debug::Block("Block::propagateLevel("+std::to_string(level)+")");
+    Debug::Block("Block::propagateLevel()", level);
     // cycle detection
     if( prop.count(getId()) > 0)
         throw MyError("Cycle detected!", ErrorType::BlockError);
@@ -279,38 +350,59 @@ void Block<T>::Compute()
     CheckTypes(mOut);
 
     // count result
-    setValue( Compute(mfunc) );
+    if(!Profile::isEnabled())
+    {
+        Compute(mfunc);
+        return;
+    }
+    unsigned long long start = Profile::now();
+    Compute(mfunc);
+    addCost(Profile::now() - start);
+}
+
+template<>
+void Block<std::function<double(double,double,EvalError&)>>::Compute(std::function<double(double,double,EvalError&)>)
+{
+    ValueStore& st = getStore();
+    long a = mIn[0]->slot, b = mIn[1]->slot;
+    EvalError e = EvalError::EvalOk;
+    double v = mfunc(st.value(a), st.value(b), e);
+    if(e != EvalError::EvalOk) throw Config::getErrorMessage(e);
+    st.set(getSlot(), v, st.typeId(a));
 }
 
 template<>
-Value Block<std::function<double(double,double)>>::Compute(std::function<double(double,double)>)
+void Block<std::function<double(double,EvalError&)>>::Compute(std::function<double(double,EvalError&)>)
 {
-    Value v;
-    v.type = mIn.at(0)->getValue().type;
-    v.value = mfunc(mIn.at(0)->getValue().value, mIn.at(1)->getValue().value);
-    v.valid = true;
-    return v;
+    ValueStore& st = getStore();
+    long a = mIn[0]->slot;
+    EvalError e = EvalError::EvalOk;
+    double v = mfunc(st.value(a), e);
+    if(e != EvalError::EvalOk) throw Config::getErrorMessage(e);
+    st.set(getSlot(), v, st.typeId(a));
 }
 
 template<>
-Value Block<std::function<double(double)>>::Compute(std::function<double(double)>)
+void Block<std::function<double(const double*,size_t,EvalError&)>>::Compute(std::function<double(const double*,size_t,EvalError&)>)
 {
-    Value v;
-    v.type = mIn.at(0)->getValue().type;
-    v.value = mfunc(mIn.at(0)->getValue().value);
-    v.valid = true;
-    return v;
+    ValueStore& st = getStore();
+    margs.resize(mIn.size());
+    for(size_t i = 0; i < mIn.size(); i++) { margs[i] = st.value(mIn[i]->slot); }
+    EvalError e = EvalError::EvalOk;
+    double v = mfunc(margs.data(), margs.size(), e);
+    if(e != EvalError::EvalOk) throw Config::getErrorMessage(e);
+    st.set(getSlot(), v, st.typeId(mIn[0]->slot));
 }
 
 template <class T>
 void Block<T>::CheckTypes(std::vector<std::shared_ptr<Port>>& v)
 {
-    std::string s = "";
+    int t = -1;
     for(auto& it: v)
     {
-        if(it->wire == nullptr) continue;
-        if(s == "") s = it->getValue().type;
-        if(s != it->getValue().type) throw "incompatible types";
+        if(it->slot < 0) continue;
+        if(t < 0) t = getStore().typeId(it->slot);
+        if(t != getStore().typeId(it->slot)) throw "incompatible types";
     }
 }
 
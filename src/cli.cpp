@@ -0,0 +1,253 @@
+/**
+ * @file cli.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief command line interface
+ *
+ * This module contains the command line modes implementation.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cli.h"
+#include "debug.h"
+#include "defs.h"
+#include "memoryreport.h"
+#include "model.h"
+#include "scheme.h"
+#include "sweep.h"
+
+namespace {
+    /** @brief Usage of the command line modes. */
+    const char* Usage =
+        "usage: blockeditor --sweep SCHEME.bsc [options]\n"
+        "  --param ID=A:B[:STEPS]     sweeps the input uniformly from A to B\n"
+        "  --param ID=normal:M:S      samples the input from the normal distribution\n"
+        "  --grid | --lhs | --mc      grid (default), Latin hypercube or Monte Carlo\n"
+        "  --points N                 count of the points (lhs, mc)\n"
+        "  --seed S                   seed of the sampling\n"
+        "  --output ID                output block (repeatable, all if not given)\n"
+        "  --threads T                count of the threads (all the cores if 0)\n"
+        "  --batch B                  count of the points in the batch\n"
+        "  --stats                    prints the statistics of the outputs instead of the points\n"
+        "  --interpret                evaluates by the bytecode only (long sweeps are compiled into the native code)\n"
+        "       blockeditor --analyze SCHEME.bsc [options]\n"
+        "  --profile RUNS             measures the costs of the blocks over the runs (estimated if not given)\n"
+        "       blockeditor --memory SCHEME.bsc   prints the memory of the model by the categories\n";
+
+    /**
+     * @brief Splits the string by the delimiter.
+     * @param s         String.
+     * @param delim     Delimiter.
+     * @returns Parts.
+     */
+    std::vector<std::string> split(const std::string& s, char delim)
+    {
+        std::vector<std::string> v;
+        std::istringstream is(s);
+        std::string f;
+        while(std::getline(is, f, delim)) v.push_back(f);
+        return v;
+    }
+
+    /**
+     * @brief Parses the swept input (ID=A:B[:STEPS] or ID=normal:M:S).
+     * @param s         Argument.
+     * @returns Axis.
+     */
+    SweepAxis parseAxis(const std::string& s)
+    {
+        size_t eq = s.find('=');
+        if(eq == std::string::npos) throw MyError("Invalid parameter "+s, ErrorType::BlockError);
+        SweepAxis ax;
+        ax.id = std::stol(s.substr(0, eq));
+        std::vector<std::string> v = split(s.substr(eq + 1), ':');
+        if(!v.empty() && v[0] == "normal")
+        {
+            if(v.size() != 3) throw MyError("Invalid parameter "+s, ErrorType::BlockError);
+            ax.dist = SweepDistribution::Normal;
+            ax.a = std::stod(v[1]);
+            ax.b = std::stod(v[2]);
+            return ax;
+        }
+        if(v.size() < 2 || v.size() > 3) throw MyError("Invalid parameter "+s, ErrorType::BlockError);
+        ax.a = std::stod(v[0]);
+        ax.b = std::stod(v[1]);
+        if(v.size() == 3) ax.steps = std::stoul(v[2]);
+        return ax;
+    }
+
+    /**
+     * @brief Sweep mode. Prints the points and the outputs as CSV, the last
+     *        column is the mask of the errors (bit 1<<EvalError) of the row.
+     *        With --stats, it prints the statistics of the outputs only.
+     * @param args      Arguments after --sweep.
+     * @returns Exit code.
+     */
+    int sweep(const std::vector<std::string>& args)
+    {
+        if(args.empty()) throw MyError("Missing scheme", ErrorType::BlockError);
+        std::string path = args[0];
+        SweepMode mode = SweepMode::Grid;
+        std::vector<SweepAxis> axes;
+        std::set<long> outputs;
+        size_t points = 1000, batch = 1024;
+        unsigned long long seed = 0;
+        unsigned threads = 0;
+        bool stats = false, interpret = false;
+        for(size_t i = 1; i < args.size(); i++)
+        {
+            const std::string& a = args[i];
+            auto value = [&]() -> const std::string& {
+                if(i + 1 >= args.size()) throw MyError("Missing value of "+a, ErrorType::BlockError);
+                return args[++i];
+            };
+            if(a == "--param") axes.push_back(parseAxis(value()));
+            else if(a == "--grid") mode = SweepMode::Grid;
+            else if(a == "--lhs") mode = SweepMode::LatinHypercube;
+            else if(a == "--mc") mode = SweepMode::MonteCarlo;
+            else if(a == "--points") points = std::stoul(value());
+            else if(a == "--seed") seed = std::stoull(value());
+            else if(a == "--output") outputs.insert(std::stol(value()));
+            else if(a == "--threads") threads = unsigned(std::stoul(value()));
+            else if(a == "--batch") batch = std::stoul(value());
+            else if(a == "--stats") stats = true;
+            else if(a == "--interpret") interpret = true;
+            else throw MyError("Unknown option "+a, ErrorType::BlockError);
+        }
+
+        Model m;
+        Scheme::build(Scheme::load(path), m);
+        Sweep s(m.buildPlan(outputs), mode, axes, points, seed);
+        s.setNative(!interpret && s.getPoints() >= Sweep::NativePoints);
+
+        // the program has the results of all the blocks it evaluates
+        const std::vector<long>& outs = s.getProgram().getOutputs();
+        std::vector<size_t> columns;
+        for(size_t k = 0; k < outs.size(); k++)
+        {
+            if(outputs.empty() || outputs.count(outs[k]) > 0) columns.push_back(k);
+        }
+        if(stats)
+        {
+            StatsCollector c(outs);
+            for(auto& it: columns) c.attachBlock(outs[it]);
+            s.aggregate(c, batch, threads);
+            std::printf("block,count,errors,mean,deviation,min,max,q05,q50,q95\n");
+            for(auto& it: columns)
+            {
+                const Stats& st = c.getBlock(outs[it]);
+                std::printf("%ld,%llu,%llu,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g\n", outs[it],
+                            st.getCount(), st.getErrors(), st.getMean(), std::sqrt(st.getVariance()),
+                            st.getMin(), st.getMax(), st.getQuantile(0.05), st.getQuantile(0.5), st.getQuantile(0.95));
+            }
+            return 0;
+        }
+
+        std::printf("point");
+        for(auto& it: axes) std::printf(",%ld", it.id);
+        for(auto& it: columns) std::printf(",%ld", outs[it]);
+        std::printf(",errors\n");
+        const size_t na = axes.size(), no = outs.size();
+        s.run([&](size_t first, size_t rows, const double* in, const double* out, const EvalError* err) {
+            for(size_t i = 0; i < rows; i++)
+            {
+                std::printf("%zu", first + i);
+                for(size_t k = 0; k < na; k++) std::printf(",%.17g", in[i*na + k]);
+                unsigned mask = 0;
+                for(auto& k: columns)
+                {
+                    std::printf(",%.17g", out[i*no + k]);
+                    if(err[i*no + k] != EvalError::EvalOk) mask |= 1u << err[i*no + k];
+                }
+                std::printf(",%u\n", mask);
+            }
+        }, batch, threads);
+        return 0;
+    }
+
+    /**
+     * @brief Analysis mode. Prints the critical path and the parallelism
+     *        of the scheme (see Analysis::analyze).
+     * @param args      Arguments after --analyze.
+     * @returns Exit code.
+     */
+    int analyze(const std::vector<std::string>& args)
+    {
+        if(args.empty()) throw MyError("Missing scheme", ErrorType::BlockError);
+        unsigned long runs = 0;
+        for(size_t i = 1; i < args.size(); i++)
+        {
+            if(args[i] == "--profile" && i + 1 < args.size()) runs = std::stoul(args[++i]);
+            else throw MyError("Unknown option "+args[i], ErrorType::BlockError);
+        }
+
+        Model m;
+        Scheme::build(Scheme::load(args[0]), m);
+        if(runs > 0)
+        {
+            m.setProfiling(true);
+            try { for(unsigned long i = 0; i < runs; i++) m.startComputation(); }
+            catch(const char* e) { throw MyError(e, ErrorType::BlockError); }
+            m.setProfiling(false);
+        }
+        SchemeAnalysis a = m.analyze();
+        std::cout << a.getSummary() << "\n" << a.getDetails();
+        return 0;
+    }
+
+    /**
+     * @brief Memory mode. Prints the memory of the model of the scheme
+     *        (see Model::accountMemory).
+     * @param args      Arguments after --memory.
+     * @returns Exit code.
+     */
+    int memory(const std::vector<std::string>& args)
+    {
+        if(args.size() != 1) throw MyError("Expected the scheme only", ErrorType::BlockError);
+        Model m;
+        Scheme::build(Scheme::load(args[0]), m);
+        MemoryReport r;
+        m.accountMemory(r);
+        std::cout << r.getText();
+        return 0;
+    }
+}
+
+bool Cli::isHeadless(int argc, char* argv[])
+{
+    if(argc < 2) return false;
+    std::string mode = argv[1];
+    return mode == "--sweep" || mode == "--analyze" || mode == "--memory";
+}
+
+int Cli::run(int argc, char* argv[])
+{
+    std::vector<std::string> args(argv + 2, argv + argc);
+    std::string mode = argv[1];
+    Debug::Controller("Cli::run()");
+    try
+    {
+        if(mode == "--sweep") return sweep(args);
+        if(mode == "--analyze") return analyze(args);
+        if(mode == "--memory") return memory(args);
+    }
+    catch(MyError& e)
+    {
+        std::cerr << e.getMessage() << "\n" << Usage;
+        return 1;
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "Invalid argument\n" << Usage;
+        return 1;
+    }
+    std::cerr << Usage;
+    return 1;
+}
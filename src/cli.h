@@ -0,0 +1,36 @@
+/**
+ * @file cli.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief command line interface
+ *
+ * This module contains the command line modes of the application. They
+ * load the scheme file without the window and print the results to the
+ * standard output.
+ */
+
+#ifndef CLI_H
+#define CLI_H
+
+/**
+ * @brief Command line namespace.
+ */
+namespace Cli
+{
+    /**
+     * @brief Indicates, weather the arguments select a command line mode.
+     * @param argc      Count of the arguments.
+     * @param argv      Arguments.
+     * @returns True, if the GUI should not be started.
+     */
+    bool isHeadless(int argc, char* argv[]);
+    /**
+     * @brief Runs the command line mode.
+     * @param argc      Count of the arguments.
+     * @param argv      Arguments.
+     * @returns Exit code.
+     */
+    int run(int argc, char* argv[]);
+}
+
+#endif // CLI_H
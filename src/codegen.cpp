@@ -0,0 +1,229 @@
+/**
+ * @file codegen.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief C++ source generator module
+ *
+ * This module contains the C++ source generator implementation.
+ */
+
+#include <cctype>
+#include <cmath>
+#include <sstream>
+
+#include "codegen.h"
+#include "debug.h"
+
+namespace {
+    /**
+     * @brief Writes the double as exact C++ literal.
+     * @param v         Value.
+     * @returns Literal.
+     */
+    std::string literal(double v)
+    {
+        if(std::isnan(v)) return "std::numeric_limits<double>::quiet_NaN()";
+        if(std::isinf(v)) return (v > 0) ? "std::numeric_limits<double>::infinity()" : "-std::numeric_limits<double>::infinity()";
+        std::ostringstream os;
+        os << std::hexfloat << v;
+        return os.str();
+    }
+
+    /**
+     * @brief Expression of the operation with one or two operands.
+     * @param op        Operation.
+     * @param x         First operand.
+     * @param y         Second operand.
+     * @returns Expression.
+     */
+    std::string expression(Opcode op, const std::string& x, const std::string& y)
+    {
+        switch(op)
+        {
+            case OpAdd: return x+" + "+y;
+            case OpSub: return x+" - "+y;
+            case OpMul: return x+" * "+y;
+            case OpDiv: return x+" / "+y;
+            case OpExp: return "std::exp("+x+")";
+            case OpAbs: return "std::fabs("+x+")";
+            case OpLog: return "std::log("+x+")";
+            case OpNeg: return "-"+x;
+            case OpSign: return "("+x+">0)?1.0:(("+x+"<0)?-1.0:0.0)";
+            case OpSquare: return x+" * "+x;
+            case OpSqrt: return "std::sqrt("+x+")";
+            case OpSqrtOfSquared: return "detail::sqrtOfSquared("+x+")";
+            default: return "";
+        }
+    }
+
+    /**
+     * @brief Error of the operation with one or two operands.
+     * @param op        Operation.
+     * @param x         First operand.
+     * @param y         Second operand.
+     * @returns Expression of the error code.
+     */
+    std::string error(Opcode op, const std::string& x, const std::string& y)
+    {
+        switch(op)
+        {
+            case OpDiv: return "("+y+" == 0) ? "+std::to_string(int(DivisionByZero))+" : 0";
+            case OpLog: return "("+x+" <= 0) ? "+std::to_string(int(NonPositiveLogarithm))+" : 0";
+            case OpSqrt: return "("+x+" < 0) ? "+std::to_string(int(NegativeSquareRoot))+" : 0";
+            default: return "0";
+        }
+    }
+
+    /**
+     * @brief Operation of the reduction.
+     * @param op        Operation.
+     * @returns Lambda.
+     */
+    std::string reduction(Opcode op)
+    {
+        switch(op)
+        {
+            case OpSum: return "[](double a, double b){return a+b;}";
+            case OpProduct: return "[](double a, double b){return a*b;}";
+            case OpMin: return "[](double a, double b){return (b<a)?b:a;}";
+            case OpMax: return "[](double a, double b){return (b>a)?b:a;}";
+            default: return "";
+        }
+    }
+}
+
+std::string CodeGen::toIdentifier(const std::string& s)
+{
+    std::string id;
+    for(auto& c: s) { id += std::isalnum((unsigned char)c) ? c : '_'; }
+    if(id.empty() || std::isdigit((unsigned char)id[0])) id = "scheme_" + id;
+    return id;
+}
+
+std::string CodeGen::generateCpp(const Program& p, const std::string& name)
+{
+    Debug::Compute("CodeGen::generateCpp()");
+    std::string guard = name;
+    for(auto& c: guard) { c = std::toupper((unsigned char)c); }
+    guard += "_H";
+
+    std::ostringstream os;
+    os << "/**\n"
+       << " * @file " << name << ".h\n"
+       << " * @brief Scheme " << name << " generated by blockeditor (do not edit).\n"
+       << " */\n\n"
+       << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+       << "#include <cmath>\n#include <cstddef>\n#include <limits>\n\n"
+       << "namespace " << name << "\n{\n";
+
+    // IDs of the blocks
+    os << "    /** @brief Count of the inputs. */\n"
+       << "    constexpr std::size_t InputCount = " << p.getInputs().size() << ";\n"
+       << "    /** @brief Count of the outputs. */\n"
+       << "    constexpr std::size_t OutputCount = " << p.getOutputs().size() << ";\n";
+    os << "    /** @brief IDs of the input blocks (order of the inputs). */\n"
+       << "    constexpr long InputIds[] = {";
+    for(size_t i = 0; i < p.getInputs().size(); i++) os << (i ? ", " : "") << p.getInputs()[i];
+    if(p.getInputs().empty()) os << "-1";
+    os << "};\n";
+    os << "    /** @brief IDs of the output blocks (order of the outputs). */\n"
+       << "    constexpr long OutputIds[] = {";
+    for(size_t i = 0; i < p.getOutputs().size(); i++) os << (i ? ", " : "") << p.getOutputs()[i];
+    if(p.getOutputs().empty()) os << "-1";
+    os << "};\n\n";
+
+    // helpers, same as in the editor
+    os << "    namespace detail\n    {\n"
+       << "        template <class F>\n"
+       << "        inline double reduce(const double* x, std::size_t n, F op)\n"
+       << "        {\n"
+       << "            if(n < 4)\n"
+       << "            {\n"
+       << "                double r = x[0];\n"
+       << "                for(std::size_t i = 1; i < n; i++) r = op(r, x[i]);\n"
+       << "                return r;\n"
+       << "            }\n"
+       << "            double a0 = x[0], a1 = x[1], a2 = x[2], a3 = x[3];\n"
+       << "            std::size_t i = 4;\n"
+       << "            for(; i + 4 <= n; i += 4)\n"
+       << "            {\n"
+       << "                a0 = op(a0, x[i]);\n"
+       << "                a1 = op(a1, x[i+1]);\n"
+       << "                a2 = op(a2, x[i+2]);\n"
+       << "                a3 = op(a3, x[i+3]);\n"
+       << "            }\n"
+       << "            for(; i < n; i++) a0 = op(a0, x[i]);\n"
+       << "            return op(op(a0, a1), op(a2, a3));\n"
+       << "        }\n"
+       << "        inline double sqrtOfSquared(double x)\n"
+       << "        {\n"
+       << "            double a = std::fabs(x);\n"
+       << "            if(a >= " << literal(SqrtOfSquaredMin) << " && a < " << literal(SqrtOfSquaredMax) << ") return a;\n"
+       << "            return std::sqrt(x * x);\n"
+       << "        }\n"
+       << "        inline double logOfExp(double x, unsigned char& e)\n"
+       << "        {\n"
+       << "            if(std::fabs(x) < " << literal(LogOfExpMax) << ") return x;\n"
+       << "            double t = std::exp(x);\n"
+       << "            if(t <= 0) e = " << int(NonPositiveLogarithm) << ";\n"
+       << "            return std::log(t);\n"
+       << "        }\n"
+       << "    }\n\n";
+
+    // function
+    os << "    /**\n"
+       << "     * @brief Evaluates the scheme.\n"
+       << "     * @param inputs    Values of the inputs (InputCount, order of InputIds).\n"
+       << "     * @param outputs   Values of the outputs (OutputCount, order of OutputIds).\n"
+       << "     * @param errors    Errors of the outputs (0 if correct, may be nullptr).\n"
+       << "     */\n"
+       << "    inline void eval(const double* inputs, double* outputs, unsigned char* errors = nullptr)\n"
+       << "    {\n"
+       << "        const double nan = std::numeric_limits<double>::quiet_NaN();\n"
+       << "        (void)nan; (void)inputs;\n";
+    for(size_t i = 0; i < p.getRegisterCount(); i++)
+        os << "        double r" << i << " = 0; unsigned char e" << i << " = 0;\n";
+    for(size_t i = 0; i < p.getInputRegisters().size(); i++)
+        os << "        r" << p.getInputRegisters()[i] << " = inputs[" << i << "];\n";
+    for(auto& it: p.getConstants())
+        os << "        r" << it.slot << " = " << literal(it.value) << "; e" << it.slot << " = " << int(it.error) << ";\n";
+
+    const std::string poisoned = std::to_string(int(Poisoned));
+    for(auto& ins: p.getCode())
+    {
+        std::string d = std::to_string(ins.dst);
+        os << "        // r" << d << " = " << Program::getOpName(ins.op) << "\n";
+        if(ins.op >= OpSum && ins.op <= OpMax)
+        {
+            std::string cond, args;
+            for(unsigned k = 0; k < ins.b; k++)
+            {
+                std::string r = std::to_string(p.getOperands()[ins.a + k]);
+                cond += (k ? " || e" : "e") + r;
+                args += (k ? ", r" : "r") + r;
+            }
+            os << "        if(" << cond << ") { r" << d << " = nan; e" << d << " = " << poisoned << "; }\n"
+               << "        else { const double args[] = {" << args << "}; r" << d << " = detail::reduce(args, "
+               << ins.b << ", " << reduction(ins.op) << "); e" << d << " = 0; }\n";
+            continue;
+        }
+        std::string x = "r" + std::to_string(ins.a), y = "r" + std::to_string(ins.b);
+        std::string cond = "e" + std::to_string(ins.a);
+        if(ins.op <= OpDiv) cond += " || e" + std::to_string(ins.b);
+        // the link of the fused chain (in place) keeps the error of the failed link
+        if(ins.op > OpDiv && ins.a == ins.dst) os << "        if(" << cond << ") { r" << d << " = nan; }\n";
+        else os << "        if(" << cond << ") { r" << d << " = nan; e" << d << " = " << poisoned << "; }\n";
+        if(ins.op == OpLogOfExp)
+            os << "        else { e" << d << " = 0; r" << d << " = detail::logOfExp(" << x << ", e" << d << "); }\n";
+        else
+            os << "        else { e" << d << " = " << error(ins.op, x, y) << "; r" << d << " = " << expression(ins.op, x, y) << "; }\n";
+    }
+
+    for(size_t i = 0; i < p.getOutputRegisters().size(); i++)
+        os << "        outputs[" << i << "] = r" << p.getOutputRegisters()[i] << ";\n";
+    os << "        if(errors == nullptr) return;\n";
+    for(size_t i = 0; i < p.getOutputRegisters().size(); i++)
+        os << "        errors[" << i << "] = e" << p.getOutputRegisters()[i] << ";\n";
+    os << "    }\n}\n\n#endif // " << guard << "\n";
+    return os.str();
+}
@@ -0,0 +1,43 @@
+/**
+ * @file codegen.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief C++ source generator interface
+ *
+ * This module generates a standalone C++ header from the compiled
+ * scheme. The header contains a straight line function evaluating the
+ * scheme with the same math as the blocks, it needs nothing but the
+ * standard library.
+ */
+
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include <string>
+
+#include "program.h"
+
+/**
+ * @brief Code generator namespace.
+ */
+namespace CodeGen
+{
+    /**
+     * @brief Generates the header. It defines, in the given namespace,
+     *        the IDs of the inputs and the outputs and the function
+     *        void eval(const double* inputs, double* outputs, unsigned char* errors = nullptr).
+     *        The errors are the values of EvalError.
+     * @param p         Compiled scheme.
+     * @param name      Namespace (C++ identifier).
+     * @returns Source of the header.
+     */
+    std::string generateCpp(const Program& p, const std::string& name);
+    /**
+     * @brief Makes a C++ identifier of the string (file name).
+     * @param s         String.
+     * @returns Identifier.
+     */
+    std::string toIdentifier(const std::string& s);
+}
+
+#endif // CODEGEN_H
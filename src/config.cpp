@@ -18,13 +18,17 @@
  */
 namespace
 {
-    std::map<long, std::function<double(double, double)>> mf_2I1O; /**< Lambdas of the 2 input 1 output blocks. */
-    std::map<long, std::function<double(double)>> mf_1I1O; /**< Lambdas of the 1 input 1 output blocks. */
+    std::map<long, std::function<double(double,double,EvalError&)>> mf_2I1O; /**< Lambdas of the 2 input 1 output blocks. */
+    std::map<long, std::function<double(double,EvalError&)>> mf_1I1O; /**< Lambdas of the 1 input 1 output blocks. */
+    std::map<long, std::function<double(const double*,size_t,EvalError&)>> mf_NI1O; /**< Reductions of the N input 1 output blocks. */
     std::map<long, std::vector<std::string>> mIn; /**< Types of the input block ports. */
     std::map<long, std::vector<std::string>> mOut; /**< Types of the output block ports. */
 
     std::map<std::string, long> mBlockNames; /**< Block name to block type mapping. */
     std::set<std::string> mTypes; /**< Types. */
+
+    std::map<std::string, int> mTypeIds; /**< Type to type id mapping. */
+    std::vector<std::string> mTypeNames; /**< Type id to type mapping. */
 }
 
 void Config::initConfig()
@@ -35,57 +39,78 @@ void Config::initConfig()
     
     int id = 0;
     mBlockNames.insert( std::make_pair("adder", id) );
-    mf_2I1O.insert( std::make_pair(id, [](double a,double b){return a+b;}) );
+    mf_2I1O.insert( std::make_pair(id, [](double a,double b,EvalError&){return a+b;}) );
     mIn.insert( std::make_pair(id, std::vector<std::string>{"general", "general"}) );
     mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
 
     mBlockNames.insert( std::make_pair("subtractor", id) );
-    mf_2I1O.insert( std::make_pair(id, [](double a,double b){return a-b;}) );
+    mf_2I1O.insert( std::make_pair(id, [](double a,double b,EvalError&){return a-b;}) );
     mIn.insert( std::make_pair(id, std::vector<std::string>{"general", "general"}) );
     mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
 
     mBlockNames.insert( std::make_pair("multiplier", id) );
-    mf_2I1O.insert( std::make_pair(id, [](double x,double y){return x*y;}) );
+    mf_2I1O.insert( std::make_pair(id, [](double x,double y,EvalError&){return x*y;}) );
     mIn.insert( std::make_pair(id, std::vector<std::string>{"general", "general"}) );
     mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
 
     mBlockNames.insert( std::make_pair("divider", id) );
-    mf_2I1O.insert( std::make_pair(id, [](double x,double y){ if(y==0)throw "division by zero"; return x/y;}) );
+    mf_2I1O.insert( std::make_pair(id, [](double x,double y,EvalError& e){ if(y==0)e=DivisionByZero; return x/y;}) );
     mIn.insert( std::make_pair(id, std::vector<std::string>{"general", "general"}) );
     mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
 
     mBlockNames.insert( std::make_pair("ex", id) );
-    mf_1I1O.insert( std::make_pair(id, [](double x){return exp(x);}) );
+    mf_1I1O.insert( std::make_pair(id, [](double x,EvalError&){return exp(x);}) );
     mIn.insert( std::make_pair(id, std::vector<std::string>{"general"}) );
     mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
 
     mBlockNames.insert( std::make_pair("abs", id) );
-    mf_1I1O.insert( std::make_pair(id, [](double x){return fabs(x);}) );
+    mf_1I1O.insert( std::make_pair(id, [](double x,EvalError&){return fabs(x);}) );
     mIn.insert( std::make_pair(id, std::vector<std::string>{"general"}) );
     mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
 
     mBlockNames.insert( std::make_pair("ln", id) );
-    mf_1I1O.insert( std::make_pair(id, [](double x){if(x<=0)throw "logarithm by non-positive"; return log(x);}) );
+    mf_1I1O.insert( std::make_pair(id, [](double x,EvalError& e){if(x<=0)e=NonPositiveLogarithm; return log(x);}) );
     mIn.insert( std::make_pair(id, std::vector<std::string>{"general"}) );
     mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
 
     mBlockNames.insert( std::make_pair("neg", id) );
-    mf_1I1O.insert( std::make_pair(id, [](double x){return -x;}) );
+    mf_1I1O.insert( std::make_pair(id, [](double x,EvalError&){return -x;}) );
     mIn.insert( std::make_pair(id, std::vector<std::string>{"general"}) );
     mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
 
     mBlockNames.insert( std::make_pair("sign", id) );
-    mf_1I1O.insert( std::make_pair(id, [](double x){return (x>0)?1:((x<0)?-1:0);}) );
+    mf_1I1O.insert( std::make_pair(id, [](double x,EvalError&){return (x>0)?1:((x<0)?-1:0);}) );
     mIn.insert( std::make_pair(id, std::vector<std::string>{"general"}) );
     mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
 
     mBlockNames.insert( std::make_pair("squared", id) );
-    mf_1I1O.insert( std::make_pair(id, [](double x){return x*x;}) );
+    mf_1I1O.insert( std::make_pair(id, [](double x,EvalError&){return x*x;}) );
     mIn.insert( std::make_pair(id, std::vector<std::string>{"general"}) );
     mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
 
     mBlockNames.insert( std::make_pair("sqrt", id) );
-    mf_1I1O.insert( std::make_pair(id, [](double x){if(x<0)throw "square root of negative"; return sqrt(x);}) );
+    mf_1I1O.insert( std::make_pair(id, [](double x,EvalError& e){if(x<0)e=NegativeSquareRoot; return sqrt(x);}) );
+    mIn.insert( std::make_pair(id, std::vector<std::string>{"general"}) );
+    mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
+
+    // N inputs, type of each of them is given
+    mBlockNames.insert( std::make_pair("sum", id) );
+    mf_NI1O.insert( std::make_pair(id, [](const double* x, size_t n, EvalError&){return reduce(x, n, [](double a, double b){return a+b;});}) );
+    mIn.insert( std::make_pair(id, std::vector<std::string>{"general"}) );
+    mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
+
+    mBlockNames.insert( std::make_pair("product", id) );
+    mf_NI1O.insert( std::make_pair(id, [](const double* x, size_t n, EvalError&){return reduce(x, n, [](double a, double b){return a*b;});}) );
+    mIn.insert( std::make_pair(id, std::vector<std::string>{"general"}) );
+    mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
+
+    mBlockNames.insert( std::make_pair("min", id) );
+    mf_NI1O.insert( std::make_pair(id, [](const double* x, size_t n, EvalError&){return reduce(x, n, [](double a, double b){return (b<a)?b:a;});}) );
+    mIn.insert( std::make_pair(id, std::vector<std::string>{"general"}) );
+    mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
+
+    mBlockNames.insert( std::make_pair("max", id) );
+    mf_NI1O.insert( std::make_pair(id, [](const double* x, size_t n, EvalError&){return reduce(x, n, [](double a, double b){return (b>a)?b:a;});}) );
     mIn.insert( std::make_pair(id, std::vector<std::string>{"general"}) );
     mOut.insert( std::make_pair(id++, std::vector<std::string>{"general"}) );
 
@@ -94,24 +119,48 @@ void Config::initConfig()
 BlockType Config::decodeBlockType(long key) {
     if(mf_2I1O.count(key) > 0) return BlockType::TwoIn_OneOut;
     else if(mf_1I1O.count(key) > 0) return BlockType::OneIn_OneOut;
+    else if(mf_NI1O.count(key) > 0) return BlockType::NIn_OneOut;
     else throw MyError("Unknown block key", ErrorType::BlockError);
 }
 
-std::function<double(double,double)> Config::getFunc_2I1O(long key)
+std::function<double(double,double,EvalError&)> Config::getFunc_2I1O(long key)
 {
     try { return mf_2I1O.at(key); }
     catch(std::out_of_range& e) { throw MyError("Unknown block key", ErrorType::BlockError); }
 }
 
-std::function<double(double)> Config::getFunc_1I1O(long key)
+std::function<double(double,EvalError&)> Config::getFunc_1I1O(long key)
 {
     try { return mf_1I1O.at(key); }
     catch(std::out_of_range& e) { throw MyError("Unknown block key", ErrorType::BlockError); }
 }
 
-std::vector<std::string> Config::getInput(long key)
+std::function<double(const double*,size_t,EvalError&)> Config::getFunc_NI1O(long key)
+{
+    try { return mf_NI1O.at(key); }
+    catch(std::out_of_range& e) { throw MyError("Unknown block key", ErrorType::BlockError); }
+}
+
+const char * Config::getErrorMessage(EvalError e)
+{
+    switch(e)
+    {
+        case EvalError::EvalOk: return "no error";
+        case EvalError::DivisionByZero: return "division by zero";
+        case EvalError::NonPositiveLogarithm: return "logarithm by non-positive";
+        case EvalError::NegativeSquareRoot: return "square root of negative";
+        case EvalError::Poisoned: return "erroneous input";
+    }
+    return "unknown error";
+}
+
+std::vector<std::string> Config::getInput(long key, int ports)
 {
-    try { return mIn.at(key); }
+    try {
+        if(mf_NI1O.count(key) == 0) return mIn.at(key);
+        if(ports < 2) throw MyError("Too few inputs", ErrorType::BlockError);
+        return std::vector<std::string>(ports, mIn.at(key).at(0));
+    }
     catch(std::out_of_range& e) { throw MyError("Unknown block type", ErrorType::BlockError); }
 }
 std::vector<std::string> Config::getOutput(long key)
@@ -134,5 +183,18 @@ std::string Config::getBlockName(long key)
 void Config::addType(std::string type) { mTypes.insert(type); }
 void Config::removeType(std::string type) { mTypes.erase(type); }
 std::set<std::string> Config::getTypes() { return mTypes; }
+int Config::getTypeId(const std::string& type)
+{
+    auto it = mTypeIds.find(type);
+    if(it != mTypeIds.end()) return it->second;
+    mTypeNames.push_back(type);
+    mTypeIds.insert( std::make_pair(type, int(mTypeNames.size())-1) );
+    return int(mTypeNames.size())-1;
+}
+const std::string& Config::getTypeName(int id)
+{
+    try { return mTypeNames.at(id); }
+    catch(std::out_of_range& e) { throw MyError("Unknown type id", ErrorType::TypeError); }
+}
 
 std::string Config::getStyleFileName() { return "styles"+PathSep+"stylesheet.qss"; }
\ No newline at end of file
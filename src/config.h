@@ -25,6 +25,20 @@ enum BlockType
 {
     OneIn_OneOut,
     TwoIn_OneOut,
+    NIn_OneOut, /**< Variable count of inputs (reduction). */
+};
+
+/**
+ * @brief Error of the evaluation, reported by the block functions
+ *        together with the value (instead of throwing).
+ */
+enum EvalError : unsigned char
+{
+    EvalOk = 0, /**< No error. */
+    DivisionByZero, /**< Division by zero. */
+    NonPositiveLogarithm, /**< Logarithm of non-positive number. */
+    NegativeSquareRoot, /**< Square root of negative number. */
+    Poisoned, /**< Some of the inputs is erroneous. */
 };
 
 /** @brief OS specific path separator. */
@@ -53,24 +67,41 @@ namespace Config
 
     /**
      * @brief Gets the lambda of the given block operation type.
-     *        Called for blocks with 2 inputs and 1 output.
+     *        Called for blocks with 2 inputs and 1 output. The lambda
+     *        does not throw, it reports the error by the last argument.
      * @param key       Key of the block.
      */
-    std::function<double(double,double)> getFunc_2I1O(long);
+    std::function<double(double,double,EvalError&)> getFunc_2I1O(long);
     /**
      * @brief Gets the lambda of the given block operation type.
-     *        Called for blocks with 1 input and 1 output.
+     *        Called for blocks with 1 input and 1 output. The lambda
+     *        does not throw, it reports the error by the last argument.
      * @param key       Key of the block.
      */
-    std::function<double(double)> getFunc_1I1O(long);
+    std::function<double(double,EvalError&)> getFunc_1I1O(long);
+    /**
+     * @brief Gets the reduction of the given block operation type.
+     *        Called for blocks with N inputs and 1 output. The reduction
+     *        does not throw, it reports the error by the last argument.
+     * @param key       Key of the block.
+     */
+    std::function<double(const double*,size_t,EvalError&)> getFunc_NI1O(long);
+
+    /**
+     * @brief Describes the evaluation error.
+     * @param e         Error.
+     * @returns Error message.
+     */
+    const char * getErrorMessage(EvalError);
 
     /**
      * @brief Returns vector of types of the input ports
      *        of the block with the given key.
      * @param key       Key of the block.
+     * @param ports     Count of inputs (only for blocks with N inputs).
      * @returns Vector of the types (strings).
      */
-    std::vector<std::string> getInput(long);
+    std::vector<std::string> getInput(long, int ports = 0);
     /**
      * @brief Returns vector of types of the output ports
      *        of the block with the given key.
@@ -119,6 +150,19 @@ namespace Config
      * @returns Set of the types.
      */
     std::set<std::string> getTypes();
+    /**
+     * @brief Maps the type to its numeric id. Ids are stable,
+     *        also after the type is removed.
+     * @param type      Type name.
+     * @returns Type id.
+     */
+    int getTypeId(const std::string&);
+    /**
+     * @brief Maps the numeric id back to the type.
+     * @param id        Type id.
+     * @returns Type name.
+     */
+    const std::string& getTypeName(int);
 
     /**
      * @brief Returns path of the file with stylesheet.
@@ -126,6 +170,37 @@ namespace Config
      */
     std::string getStyleFileName();
 
+    /**
+     * @brief Reduces the array with the given operation. Uses four
+     *        independent accumulators, so the operations do not form
+     *        one long dependency chain and the loop can be vectorized.
+     * @param x         Array.
+     * @param n         Length of the array (at least 1).
+     * @param op        Associative operation.
+     * @returns Reduced value.
+     */
+    template <class F>
+    double reduce(const double* x, size_t n, F op)
+    {
+        if(n < 4)
+        {
+            double r = x[0];
+            for(size_t i = 1; i < n; i++) r = op(r, x[i]);
+            return r;
+        }
+        double a0 = x[0], a1 = x[1], a2 = x[2], a3 = x[3];
+        size_t i = 4;
+        for(; i + 4 <= n; i += 4)
+        {
+            a0 = op(a0, x[i]);
+            a1 = op(a1, x[i+1]);
+            a2 = op(a2, x[i+2]);
+            a3 = op(a3, x[i+3]);
+        }
+        for(; i < n; i++) a0 = op(a0, x[i]);
+        return op(op(a0, a1), op(a2, a3));
+    }
+
 }
 
 #endif // CONFIG_H
@@ -11,14 +11,22 @@
 #include <iostream>
 #include <fstream>
 #include <cassert>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
 
 #include <QObject>
 #include <QMainWindow>
 
+#include "codegen.h"
 #include "config.h"
 #include "controller.h"
 #include "debug.h"
 #include "defs.h"
+#include "memoryreport.h"
+#include "scheme.h"
+#include "stats.h"
+#include "sweep.h"
 
 Controller::Controller()
 {
@@ -26,7 +34,7 @@ Controller::Controller()
     win->setCentralWidget(&w);
     win->show();
 
-    QObject::connect(w.getPG(), SIGNAL(sigCreateBlock(long, long&)), &m, SLOT(slotCreateBlock(long, long&)), Qt::DirectConnection);
+    QObject::connect(w.getPG(), SIGNAL(sigCreateBlock(long, int, long&)), &m, SLOT(slotCreateBlock(long, int, long&)), Qt::DirectConnection);
     QObject::connect(w.getPG(), SIGNAL(sigDeleteBlock(long)), &m, SLOT(slotDeleteBlock(long)));
     qRegisterMetaType<PortID>("PortID");
     QObject::connect(w.getPG(), SIGNAL(sigCreateWire(PortID, PortID, long&, bool&)), &m, SLOT(slotCreateWire(PortID, PortID, long&, bool&)), Qt::DirectConnection);
@@ -34,110 +42,56 @@ Controller::Controller()
     qRegisterMetaType<Value>("Value");
     QObject::connect(w.getPG(), SIGNAL(sigCreateInput(Value, long&)), &m, SLOT(slotCreateInput(Value, long&)), Qt::DirectConnection);
     QObject::connect(w.getPG(), SIGNAL(sigInputValueChanged(long,Value)), &m, SLOT(slotInputValueChanged(long,Value)));
+    QObject::connect(w.getPG(), SIGNAL(sigInputConstantChanged(long,bool)), &m, SLOT(slotInputConstantChanged(long,bool)));
 
     QObject::connect(&m, SIGNAL(sigDeleteWire(long)), w.getPG(), SLOT(slotDeleteWire(long)), Qt::DirectConnection);
 
     QObject::connect(&w, SIGNAL(sigReset()), &m, SLOT(slotReset()));
     QObject::connect(&w, SIGNAL(sigOpen(std::string)), this, SLOT(slotOpen(std::string)));
     QObject::connect(&w, SIGNAL(sigSave(std::string)), this, SLOT(slotSave(std::string)));
+    QObject::connect(&w, SIGNAL(sigExportProgram(std::string)), this, SLOT(slotExportProgram(std::string)));
+    QObject::connect(&w, SIGNAL(sigExportCpp(std::string)), this, SLOT(slotExportCpp(std::string)));
     QObject::connect(&w, SIGNAL(sigRun(bool)), this, SLOT(slotRun(bool)));
+    QObject::connect(&w, SIGNAL(sigStatistics(long,double)), this, SLOT(slotStatistics(long,double)));
+    QObject::connect(&w, SIGNAL(sigProfile(bool)), this, SLOT(slotProfile(bool)));
+    QObject::connect(&w, SIGNAL(sigAnalyze()), this, SLOT(slotAnalyze()));
+    QObject::connect(&w, SIGNAL(sigMemory()), this, SLOT(slotMemory()));
     QObject::connect(&w, SIGNAL(sigPreviousResult()), this, SLOT(slotPreviousResult()));
     QObject::connect(&w, SIGNAL(sigNextResult()), this, SLOT(slotNextResult()));
     QObject::connect(&w, SIGNAL(sigEndComputation()), this, SLOT(slotEndComputation()));
+    QObject::connect(&w, SIGNAL(sigCancel()), this, SLOT(slotCancel()));
+    QObject::connect(&w, SIGNAL(sigPlay(double,int)), this, SLOT(slotPlay(double,int)));
+    QObject::connect(&w, SIGNAL(sigPause(bool)), this, SLOT(slotPause(bool)));
+    QObject::connect(&w, SIGNAL(sigPlaybackSpeed(double,int)), this, SLOT(slotPlaybackSpeed(double,int)));
+    QObject::connect(&mplaytimer, SIGNAL(timeout()), this, SLOT(slotPlayFrame()));
+
+    // long computations run in the thread of the evaluator, the results come back queued
+    mevaluator.moveToThread(&mthread);
+    QObject::connect(&mevaluator, SIGNAL(sigStart()), &mevaluator, SLOT(slotRun()), Qt::QueuedConnection);
+    QObject::connect(&mevaluator, SIGNAL(sigFinished(QString,bool)), this, SLOT(slotFinished(QString,bool)), Qt::QueuedConnection);
+    QObject::connect(&mprogresstimer, SIGNAL(timeout()), this, SLOT(slotProgress()));
+    mthread.start();
     w.show();
 }
 
-std::vector<std::string> split(std::string s)
+Controller::~Controller()
 {
-    std::string delimiter = ",";
-    size_t pos = 0;
-    std::vector<std::string> v;
-    std::string token;
-    while ((pos = s.find(delimiter)) != std::string::npos) {
-        token = s.substr(0, pos);
-        v.push_back(token);
-        s.erase(0, pos + delimiter.length());
-    }
-    v.push_back(s);
-    return v;
+    mevaluator.cancel();
+    mthread.quit();
+    mthread.wait();
 }
 
 void Controller::slotOpen(std::string path)
 {
     Debug::Controller("Controller::slotOpen");
-    std::filebuf fb;
-    fb.open (path,std::ios::in);
-    std::istream os(&fb);
-
-    std::string s;
-    if(!getline(os,s) || s != "# BLOCKS #") exit(1);
+    SchemeFile f;
+    try { f = Scheme::load(path); }
+    catch(MyError& e) { w.showDialog(e.getMessage().c_str()); return; }
 
     GuiState gs;
-    ModelState ms;
-
-    while( getline(os, s) ) {
-        if(s == "# WIRES #") break;
-        if(s == "") continue;
-        std::vector<std::string> v = split(s);
-        try {
-            long id = std::stol(v.at(0));
-            long type = std::stol(v.at(1));
-            double x = std::stod(v.at(2));
-            double y = std::stod(v.at(3));
-
-            GuiBlockDescriptor g;
-            g.pos = std::make_pair(x,y);
-            g.type = type;
-            g.val.type = v.at(4);
-            if(v.at(5) == "true") g.val.valid = true;
-            else g.val.valid = false;
-            g.val.value = std::stod(v.at(6));
-
-            gs.blocks.insert( std::make_pair(id, g) );
-            ms.blocks.insert( std::make_pair(id, type) );
-        } catch(std::exception& e) {
-            w.showDialog("Invalid input file!");
-            return;
-        }
-    }
-
-    // read wires
-    while( getline(os, s) ) {
-        if(s == "# TYPES #") break;
-        if(s == "") continue;
-        std::vector<std::string> v = split(s);
-
-        try {
-            struct wireState wire;
-            //wire.id = std::stol(v.at(0));
-            //wire.point1_x = std::stod(v.at(1));
-            //wire.point1_y = std::stod(v.at(2));
-            //wire.point2_x = std::stod(v.at(3));
-            //wire.point2_y = std::stod(v.at(4));
-            wire.block1_id = std::stol(v.at(0));
-            wire.block2_id = std::stol(v.at(1));
-            wire.connector1 = std::stoi(v.at(2));
-            wire.connector2 = std::stoi(v.at(3));
-
-            //GuiBlockDescriptor g;
-            //g.pos = std::make_pair(x,y);
-            //g.type = type;
-
-            //gs.blocks.insert( std::make_pair(id, g) );
-            gs.wires.push_back(wire);
-            //ms.blocks.insert( std::make_pair(id, type) );
-        } catch(std::exception& e) {
-            w.showDialog("Invalid input file!");
-            return;
-        }
-
-    }
-
-    std::vector<std::string> newtypes;
-    while( getline(os, s) ) {
-        newtypes.push_back(s);
-    }
-
+    gs.blocks = f.blocks;
+    gs.wires = f.wires;
+    ModelState ms = Scheme::getModelState(f);
 
     w.reinit();
     m.reinit();
@@ -146,7 +100,71 @@ void Controller::slotOpen(std::string path)
 
     m.setState(ms);
     w.setState(gs);
-    for(auto& it: newtypes) { Config::addType(it); }
+    for(auto& it: f.types) { Config::addType(it); }
+}
+
+void Controller::slotExportProgram(std::string path)
+{
+    Debug::Controller("Controller::slotExportProgram");
+    try { m.compileProgram().save(path); }
+    catch(MyError& e) { w.showDialog(e.getMessage().c_str()); }
+}
+
+void Controller::slotExportCpp(std::string path)
+{
+    Debug::Controller("Controller::slotExportCpp");
+    // namespace is the name of the file
+    std::string name = path.substr(path.find_last_of(PathSep) + 1);
+    name = CodeGen::toIdentifier(name.substr(0, name.find('.')));
+    try
+    {
+        std::string src = CodeGen::generateCpp(m.compileProgram(), name);
+        std::ofstream os(path);
+        os << src;
+        if(!os) w.showDialog("Cannot write the file!");
+    }
+    catch(MyError& e) { w.showDialog(e.getMessage().c_str()); }
+}
+
+void Controller::slotStatistics(long samples, double spread)
+{
+    Debug::Controller("Controller::slotStatistics");
+    if(mbusy) return;
+    try
+    {
+        // uniform around the current values of the variable inputs
+        Plan p = m.buildPlan();
+        std::vector<SweepAxis> axes;
+        for(size_t i = 0; i < p.getInputs().size(); i++)
+        {
+            double v = p.getDefaults()[i];
+            double d = (v != 0) ? std::fabs(v) * spread : spread;
+            SweepAxis ax;
+            ax.id = p.getInputs()[i];
+            ax.a = v - d;
+            ax.b = v + d;
+            axes.push_back(ax);
+        }
+        std::shared_ptr<Sweep> s = std::make_shared<Sweep>(p, SweepMode::MonteCarlo, axes, size_t(samples));
+        s->setNative(s->getPoints() >= Sweep::NativePoints);
+
+        std::shared_ptr<StatsCollector> c = std::make_shared<StatsCollector>(s->getProgram().getOutputs());
+        std::map<long,long> wires = m.getWireSources();
+        for(auto& it: s->getProgram().getOutputs()) { c->attachBlock(it); }
+        for(auto& it: wires) { if(p.getSlots().count(it.second) > 0) c->attachWire(it.first, it.second); }
+
+        // the sweep has its own program, it does not touch the model
+        startJob([s, c](ComputeProgress& progress) {
+            s->setProgress(&progress);
+            s->aggregate(*c);
+        }, [this, c]() {
+            SimulationResults r = c->getResults();
+            for(auto& i: r.blocks) { for(auto& j: i.second) w.getPG()->setBlockStats(j.first, j.second.details); }
+            for(auto& i: r.wires) { for(auto& j: i.second) w.getPG()->setWireStats(j.first, j.second.details); }
+            w.endComputation();
+        });
+    }
+    catch(MyError& e) { w.showDialog(e.getMessage().c_str()); }
 }
 
 void Controller::slotSave(std::string path)
@@ -155,69 +173,136 @@ void Controller::slotSave(std::string path)
     // get states
     GuiState gs = w.getState();
     ModelState ms = m.getState();
-    // open file
-    std::filebuf fb;
-    fb.open (path,std::ios::out);
-    std::ostream os(&fb);
-    // save blocks
-    os << "# BLOCKS #\n";
+    SchemeFile f;
     for(auto& it: gs.blocks)
     {
-        std::string validStr;
-        if(it.second.val.valid) validStr = "true";
-        else validStr = "false";
-
-        os << it.first << ","
-           << ms.blocks.at(it.first) << ","
-           << it.second.pos.first << ","
-           << it.second.pos.second << ","
-           << it.second.val.type << ","
-           << validStr << ","
-           << it.second.val.value << "\n";
+        GuiBlockDescriptor g = it.second;
+        g.type = ms.blocks.at(it.first);
+        g.ports = (ms.ports.count(it.first) > 0) ? ms.ports.at(it.first) : 0;
+        g.constant = ms.constants.count(it.first) > 0;
+        f.blocks.insert( std::make_pair(it.first, g) );
     }
-    // save wires
-    os << "# WIRES #\n";
-    for(auto& it: gs.wires)
-    {
-        os //<< it.id << ","
-           //<< it.point1_x << ","
-           //<< it.point1_y << ","
-           //<< it.point2_x << ","
-           //<< it.point2_y << ","
-           << it.block1_id << ","
-           << it.block2_id << ","
-           << it.connector1 << ","
-           << it.connector2 << "\n";
-    }
-    // ...
+    f.wires = gs.wires;
+    for(auto& it: Config::getTypes()) { f.types.push_back(it); }
+    // open file
+    std::ofstream os(path);
+    Scheme::write(os, f);
+}
 
-    // save types
-    os << "# TYPES #\n";
-    for(auto& it: Config::getTypes())
-    {
-        os << it << "\n";
-    }
+void Controller::slotRun(bool debug)
+{
+    Debug::Controller("Controller::slotRun(dbg)", debug);
+    if(mbusy) return;
+    // the window is in the compute mode, the scheme does not change until the end
+    std::shared_ptr<SimulationResults> results = std::make_shared<SimulationResults>();
+    startJob([this, results](ComputeProgress& progress) { *results = m.startComputation(&progress); },
+             [this, results, debug]() { showResults(*results, debug); });
+}
+
+void Controller::slotPlay(double levels, int fps)
+{
+    Debug::Controller("Controller::slotPlay(fps)", fps);
+    if(mbusy) return;
+    std::shared_ptr<SimulationResults> results = std::make_shared<SimulationResults>();
+    startJob([this, results](ComputeProgress& progress) { *results = m.startComputation(&progress); },
+             [this, results, levels, fps]() {
+                 // stepped by the timer instead of the user
+                 showResults(*results, true);
+                 slotPlaybackSpeed(levels, fps);
+                 mplaying = true;
+                 mpaused = false;
+                 mplaydue = 1;
+                 w.setPlaying(true);
+                 mplayclock.start();
+                 mplaytimer.start();
+                 slotPlayFrame();
+             });
+}
 
-    fb.close();
+void Controller::slotPause(bool paused)
+{
+    Debug::Controller("Controller::slotPause", paused);
+    mpaused = paused;
+    if(!mplaying) return;
+    if(paused) { mplaytimer.stop(); return; }
+    // the pause is not caught up
+    mplayclock.restart();
+    mplaytimer.start();
 }
 
-void Controller::slotRun(bool debug)
+void Controller::slotPlaybackSpeed(double levels, int fps)
 {
-    Debug::Controller("Controller::slotRun(dbg="
-                     + std::string(((debug)?"true":"false"))
-                     + ")" );
-    // compute
-    SimulationResults results;
-    try { results = m.startComputation(); }
-    catch(const char * e) { w.showDialog(e); return; }
+    Debug::Controller("Controller::slotPlaybackSpeed(fps)", fps);
+    mlevelrate = levels;
+    mplaytimer.setInterval(1000 / std::max(fps, 1));
+}
+
+void Controller::slotPlayFrame()
+{
+    Debug::Span span(Debug::TraceController, "Controller::slotPlayFrame()");
+    // the levels due since the last frame are shown at once, the scene repaints them in one pass
+    mplaydue += double(mplayclock.restart()) * mlevelrate / 1000;
+    while(mplaydue >= 1 && nextLevel()) mplaydue -= 1;
+    if(mblockresults.size() <= mblockit) w.endComputation();
+}
+
+void Controller::stopPlayback()
+{
+    mplaytimer.stop();
+    mplaying = false;
+    mplaydue = 0;
+    w.setPlaying(false);
+}
+
+void Controller::startJob(const Evaluator::Job& job, const std::function<void()>& done)
+{
+    mbusy = true;
+    mdone = done;
+    w.setBusy(true);
+    mevaluator.start(job);
+    mprogresstimer.start(100);
+}
+
+void Controller::slotProgress()
+{
+    const ComputeProgress& p = mevaluator.getProgress();
+    w.setProgress(p.done, p.total);
+}
+
+void Controller::slotCancel()
+{
+    Debug::Controller("Controller::slotCancel");
+    if(mbusy) mevaluator.cancel();
+}
+
+void Controller::slotFinished(QString error, bool cancelled)
+{
+    Debug::Controller("Controller::slotFinished(cancelled)", cancelled);
+    mprogresstimer.stop();
+    mbusy = false;
+    w.setBusy(false);
+    std::function<void()> done = mdone;
+    mdone = nullptr;
+    if(cancelled) { w.endComputation(); return; }
+    if(!error.isEmpty()) { w.showDialog(error.toStdString().c_str()); return; }
+    done();
+}
+
+void Controller::showResults(const SimulationResults& results, bool debug)
+{
+    Debug::Span span(Debug::TraceController, "Controller::showResults()");
+    if(m.isProfiling()) showProfile();
     std::vector<std::pair<long, Result>> r;
-    for(auto& i: results.blocks)
     {
-        for(auto& j: i.second)
+        Debug::Span collect(Debug::TraceController, "Controller::showResults(): collect results");
+        for(auto& i: results.blocks)
         {
-            //std::cerr << "id " << j.first << " level " << i.first << "\n";
-            assert(i.first == j.second.level);
-            r.push_back( std::make_pair(j.first,j.second) );
+            for(auto& j: i.second)
+            {
+                //std::cerr << "id " << j.first << " level " << i.first << "\n";
+                assert(i.first == j.second.level);
+                r.push_back( std::make_pair(j.first,j.second) );
+            }
         }
     }
     mblockresults = r;
@@ -227,6 +312,7 @@ void Controller::slotRun(bool debug)
 
     if(!debug)
     {
+        Debug::Span update(Debug::TraceController, "Controller::showResults(): update window");
         while(mblockresults.size() > mblockit)
         {
             slotNextResult();
@@ -236,6 +322,60 @@ void Controller::slotRun(bool debug)
 
 }
 
+void Controller::slotProfile(bool on)
+{
+    Debug::Controller("Controller::slotProfile", on);
+    m.setProfiling(on);
+    m.resetProfile();
+    if(!on) w.getPG()->clearHeat();
+}
+
+void Controller::slotAnalyze()
+{
+    Debug::Controller("Controller::slotAnalyze");
+    SchemeAnalysis a;
+    try { a = m.analyze(); }
+    catch(MyError& e) { w.showDialog(e.getMessage().c_str()); return; }
+    w.getPG()->setAllDefaultColor();
+    for(auto& it: a.path) w.getPG()->setBlockColor(it, true);
+    for(auto& it: a.wires) w.getPG()->setWireColor(it, true);
+    w.showReport("Critical path", a.getSummary(), a.getDetails());
+}
+
+void Controller::slotMemory()
+{
+    Debug::Controller("Controller::slotMemory");
+    MemoryReport model, gui;
+    m.accountMemory(model);
+    w.getPG()->accountMemory(gui);
+    std::ostringstream os;
+    os << "Model: " << model.getTotal() << " bytes\nGUI: " << gui.getTotal() << " bytes\n";
+    w.showReport("Memory usage", os.str(), "model\n" + model.getText() + "\ngui\n" + gui.getText());
+}
+
+void Controller::showProfile()
+{
+    // the costs differ by orders, the heat is logarithmic between the cheapest and the dearest
+    std::map<long,BlockCost> p = m.getProfile();
+    double lo = 0, hi = 0;
+    for(auto& it: p)
+    {
+        if(it.second.calls == 0) continue;
+        double c = std::max(it.second.getNsPerCall(), 1.0);
+        lo = (lo == 0) ? c : std::min(lo, c);
+        hi = std::max(hi, c);
+    }
+    for(auto& it: p)
+    {
+        if(it.second.calls == 0) continue;
+        double c = std::max(it.second.getNsPerCall(), 1.0);
+        double heat = (hi > lo) ? std::log(c / lo) / std::log(hi / lo) : 1;
+        std::ostringstream os;
+        os << "Cost: " << it.second.getNsPerCall() << " ns/eval\nEvaluations: " << it.second.calls;
+        w.getPG()->setBlockHeat(it.first, heat, os.str());
+    }
+}
+
 void Controller::slotPreviousResult()
 {
     if(mblockit == 0) return;
@@ -250,7 +390,7 @@ void Controller::slotPreviousResult()
             slotNextResult();
         }
         mblockit--;
-        Debug::Compute("slotPreviousResult() = " + std::to_string(mblockit));
+        Debug::Compute("slotPreviousResult()", mblockit);
     }
 }
 
@@ -267,7 +407,7 @@ void Controller::slotNextResult()
     {
         long id = mblockresults.at(mblockit).first;
         Value v = (Value)mblockresults.at(mblockit).second;
-        Debug::Compute(std::to_string(mblockit) + ": block " + std::to_string(id));
+        Debug::Compute("slotNextResult(step, block)", mblockit, id);
 
         w.getPG()->setBlockValue(id, v);
         w.getPG()->setBlockColor(id, true);
@@ -275,6 +415,17 @@ void Controller::slotNextResult()
     }
 }
 
+bool Controller::nextLevel()
+{
+    if(mblockresults.size() <= mblockit) return false;
+    const int level = mblockresults.at(mblockit).second.level;
+    while(mblockresults.size() > mblockit && mblockresults.at(mblockit).second.level == level)
+    {
+        slotNextResult();
+    }
+    return true;
+}
+
 void Controller::sendWireResults(int level)
 {
     if(mwireresults.count(level) == 0) return;
@@ -289,6 +440,9 @@ void Controller::sendWireResults(int level)
 
 void Controller::slotEndComputation()
 {
+    // the values are reset, when the running job stops
+    if(mbusy) { mevaluator.cancel(); return; }
+    if(mplaying) stopPlayback();
     mlastlevel = 0;
     mwireresults.clear();
     mblockresults.clear();
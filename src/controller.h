@@ -11,8 +11,15 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include <functional>
+#include <memory>
+
+#include <QElapsedTimer>
 #include <QObject>
+#include <QThread>
+#include <QTimer>
 
+#include "evaluator.h"
 #include "model.h"
 #include "window.h"
 
@@ -28,6 +35,10 @@ class Controller: public QObject
          * @brief   Controller constructor. Connects the model and the window.
          */ 
         Controller();
+        /**
+         * @brief   Controller destructor. Stops the thread of the evaluator.
+         */
+        ~Controller();
 
     public slots:
         /**
@@ -42,11 +53,66 @@ class Controller: public QObject
          * @param path      Path to the file.
          */
         void slotSave(std::string);
+        /**
+         * @brief   Compiles the scheme into the bytecode and saves it.
+         *          Called from the window, where the dialog is raised.
+         * @param path      Path to the file.
+         */
+        void slotExportProgram(std::string);
+        /**
+         * @brief   Generates the standalone C++ header of the scheme and saves it.
+         *          Called from the window, where the dialog is raised.
+         * @param path      Path to the file.
+         */
+        void slotExportCpp(std::string);
+        /**
+         * @brief   Evaluates the scheme with random values of the variable inputs
+         *          and shows the statistics of the blocks and the wires in the tooltips.
+         * @param samples   Count of the runs.
+         * @param spread    Relative spread of the inputs around their values.
+         */
+        void slotStatistics(long samples, double spread);
+        /**
+         * @brief   Turns the profiling of the blocks on or off. The costs are
+         *          accumulated over the runs and shown by the color of the blocks.
+         * @param on        Profiling is on, if true.
+         */
+        void slotProfile(bool on);
+        /**
+         * @brief   Analyses the critical path and the parallelism of the scheme,
+         *          highlights the path and shows the report.
+         */
+        void slotAnalyze();
+        /**
+         * @brief   Shows the memory used by the model and by the scene.
+         */
+        void slotMemory();
         /**
          * @brief   Runs the computation
          * @param dbg       Weather to step, or run altogether.
          */
         void slotRun(bool);
+        /**
+         * @brief   Runs the computation and plays the results level by level.
+         * @param levels    Levels shown per second.
+         * @param fps       Frames per second.
+         */
+        void slotPlay(double levels, int fps);
+        /**
+         * @brief   Pauses or resumes the playback.
+         * @param paused    True, if paused.
+         */
+        void slotPause(bool paused);
+        /**
+         * @brief   Changes the speed of the playback.
+         * @param levels    Levels shown per second.
+         * @param fps       Frames per second.
+         */
+        void slotPlaybackSpeed(double levels, int fps);
+        /**
+         * @brief   Shows the levels due since the last frame (timer).
+         */
+        void slotPlayFrame();
         /**
          * @brief   Sends next result in computation.
          */
@@ -59,21 +125,76 @@ class Controller: public QObject
          * @brief   End computation (from window).
          */
         void slotEndComputation();
+        /**
+         * @brief   Cancels the computation running in the background.
+         */
+        void slotCancel();
+        /**
+         * @brief   Shows the progress of the computation (timer).
+         */
+        void slotProgress();
+        /**
+         * @brief   Received (queued) from the evaluator, when the job ends.
+         * @param error     Message of the error (empty, if none).
+         * @param cancelled True, if the job was cancelled.
+         */
+        void slotFinished(QString error, bool cancelled);
 
     private:
         Model m; /**< Model object. */
         Window w; /**< Window object. */
 
+        /* -------- background computation ---------- */
+        QThread mthread; /**< Thread of the evaluator. */
+        Evaluator mevaluator; /**< Evaluator (lives in mthread). */
+        QTimer mprogresstimer; /**< Timer of the progress updates. */
+        bool mbusy = false; /**< Job of the evaluator runs. */
+        std::function<void()> mdone; /**< Shows the results of the job (in the thread of the window). */
+        /**
+         * @brief   Starts the job in the background. The model must not be
+         *          edited until it ends (the window is in the compute mode).
+         * @param job       Job (in the thread of the evaluator).
+         * @param done      Shows the results (in the thread of the window, if the job succeeds).
+         */
+        void startJob(const Evaluator::Job& job, const std::function<void()>& done);
+        /**
+         * @brief   Shows the results of the run.
+         * @param results   Results.
+         * @param debug     True, if stepped by the user.
+         */
+        void showResults(const SimulationResults& results, bool debug);
+
         /* -------- computation variables ---------- */
         int mlastlevel = 0; /**< Last result level. */
         std::map<int,std::map<long,Result>> mwireresults; /**< Results of wires. */
         std::vector<std::pair<long,Result>> mblockresults; /**< Results of blocks */
         size_t mblockit; /**< Block iterator. */
+        /**
+         * @brief   Shows the rest of the current level (or the next level).
+         * @returns False, if all the results are shown.
+         */
+        bool nextLevel();
+
+        /* -------- playback ---------- */
+        QTimer mplaytimer; /**< Timer of the frames. */
+        QElapsedTimer mplayclock; /**< Time since the last frame. */
+        double mlevelrate = 0; /**< Levels per second. */
+        double mplaydue = 0; /**< Levels due, not shown yet. */
+        bool mplaying = false; /**< Results are played. */
+        bool mpaused = false; /**< Playback is paused. */
+        /**
+         * @brief   Stops the playback.
+         */
+        void stopPlayback();
         /**
          * @brief   Emits all the wires at the given level.
          * @param level     Level of the emitted wires.
          */
         void sendWireResults(int level);
+        /**
+         * @brief   Shows the costs of the blocks (profiling) by their color and tooltip.
+         */
+        void showProfile();
         /* ----------------------------------------- */
 };
 
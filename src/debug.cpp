@@ -0,0 +1,227 @@
+/**
+ * @file debug.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief Debug module
+ *
+ * This module contains the recording of the trace events.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+#include "debug.h"
+
+namespace {
+    /** @brief Count of the events in the ring (power of two). */
+    const unsigned long long Capacity = 1 << 14;
+
+    /**
+     * @brief Ring buffer of the events of one thread. Only its thread writes
+     *        it, the head is published after the event is written.
+     */
+    struct Ring {
+        std::vector<Debug::Event> events; /**< Events. */
+        std::atomic<unsigned long long> head{0}; /**< Count of the recorded events. */
+        std::atomic<bool> used{false}; /**< Some thread owns the ring. */
+        unsigned short thread = 0; /**< Index of the thread. */
+    };
+
+    /** @brief Rings of all the threads (a ring of the finished thread is reused). */
+    std::vector<std::unique_ptr<Ring>> Rings;
+    /** @brief Lock of the list of the rings (not of the rings). */
+    std::mutex RingsLock;
+    /** @brief Start of the time. */
+    const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+
+    /**
+     * @brief Ring of the thread, taken on the first event and given back at its end.
+     */
+    struct Owner {
+        Ring* ring = nullptr; /**< Ring. */
+        /**
+         * @brief Owner destructor.
+         */
+        ~Owner() { if(ring != nullptr) ring->used = false; }
+        /**
+         * @brief Ring getter.
+         * @returns Ring of the thread.
+         */
+        Ring& get()
+        {
+            if(ring != nullptr) return *ring;
+            std::lock_guard<std::mutex> lock(RingsLock);
+            for(auto& it: Rings)
+            {
+                bool expected = false;
+                if(it->used.compare_exchange_strong(expected, true)) { ring = it.get(); return *ring; }
+            }
+            Rings.emplace_back(new Ring());
+            ring = Rings.back().get();
+            ring->events.resize(Capacity);
+            ring->thread = (unsigned short)(Rings.size() - 1);
+            ring->used = true;
+            return *ring;
+        }
+    };
+
+    /** @brief Ring of this thread. */
+    thread_local Owner Local;
+
+    /** @brief Names of the categories (by the bit). */
+    const char* Names[] = {"block", "model", "events", "gui", "controller", "compute", "file"};
+}
+
+void Debug::record(unsigned category, const char* what, const double* args, unsigned count, char phase)
+{
+    Ring& r = Local.get();
+    unsigned long long h = r.head.load(std::memory_order_relaxed);
+    Event& e = r.events[h & (Capacity - 1)];
+    e.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+    e.what = what;
+    for(unsigned i = 0; i < count; i++) e.args[i] = args[i];
+    e.category = (unsigned char)category;
+    e.count = (unsigned char)count;
+    e.thread = r.thread;
+    e.phase = phase;
+    r.head.store(h + 1, std::memory_order_release);
+}
+
+unsigned Debug::parse(const std::string& names)
+{
+    unsigned c = 0;
+    std::istringstream is(names);
+    std::string s;
+    while(std::getline(is, s, ','))
+    {
+        if(s == "all") c |= ~0u;
+        for(unsigned i = 0; i < sizeof(Names) / sizeof(Names[0]); i++)
+        {
+            if(s == Names[i]) c |= 1u << i;
+        }
+    }
+    return c;
+}
+
+void Debug::enable(unsigned categories) { Enabled.store(categories & Compiled, std::memory_order_relaxed); }
+
+void Debug::init()
+{
+    const char* s = std::getenv("BLOCKEDITOR_TRACE");
+    if(s != nullptr) enable(parse(s));
+    else if(std::getenv("BLOCKEDITOR_TRACE_FILE") != nullptr) enable(~0u);
+}
+
+void Debug::finish()
+{
+    if(Enabled == 0) return;
+    const char* path = std::getenv("BLOCKEDITOR_TRACE_FILE");
+    if(path == nullptr)
+    {
+        dump(std::cerr);
+        return;
+    }
+    std::ofstream os(path);
+    if(os) writeChromeTrace(os);
+    else std::cerr << "Cannot write " << path << "\n";
+}
+
+std::vector<Debug::Event> Debug::collect()
+{
+    std::vector<Event> v;
+    std::lock_guard<std::mutex> lock(RingsLock);
+    for(auto& it: Rings)
+    {
+        unsigned long long h = it->head.load(std::memory_order_acquire);
+        for(unsigned long long i = (h > Capacity) ? h - Capacity : 0; i < h; i++)
+            v.push_back(it->events[i & (Capacity - 1)]);
+    }
+    std::stable_sort(v.begin(), v.end(), [](const Event& a, const Event& b) { return a.time < b.time; });
+    return v;
+}
+
+void Debug::clear()
+{
+    std::lock_guard<std::mutex> lock(RingsLock);
+    for(auto& it: Rings) it->head.store(0, std::memory_order_relaxed);
+}
+
+const char* Debug::getCategoryName(unsigned category)
+{
+    for(unsigned i = 0; i < sizeof(Names) / sizeof(Names[0]); i++)
+    {
+        if(category == (1u << i)) return Names[i];
+    }
+    return "unknown";
+}
+
+std::string Debug::format(const Event& e)
+{
+    std::ostringstream os;
+    os << e.what;
+    if(e.count == 0) return os.str();
+    for(unsigned i = 0; i < e.count; i++)
+    {
+        os << ((i > 0) ? ", " : ": ");
+        // the IDs and the counts are whole
+        if(std::fabs(e.args[i]) < 1e15 && e.args[i] == std::floor(e.args[i])) os << (long long)e.args[i];
+        else os << e.args[i];
+    }
+    return os.str();
+}
+
+void Debug::dump(std::ostream& os)
+{
+    for(auto& it: collect())
+    {
+        char head[64];
+        std::snprintf(head, sizeof(head), "%12.3f us [%u] %-10s ", double(it.time) / 1000, unsigned(it.thread),
+                      getCategoryName(it.category));
+        const char* mark = (it.phase == 'B') ? "begin " : ((it.phase == 'E') ? "end " : "");
+        os << head << mark << format(it) << "\n";
+    }
+}
+
+void Debug::writeChromeTrace(std::ostream& os)
+{
+    os << "{\"traceEvents\":[";
+    bool first = true;
+    for(auto& it: collect())
+    {
+        os << (first ? "\n" : ",\n") << "{\"name\":\"";
+        first = false;
+        for(const char* c = it.what; *c != '\0'; c++)
+        {
+            if(*c == '"' || *c == '\\') os << '\\';
+            os << *c;
+        }
+        char times[96];
+        std::snprintf(times, sizeof(times), "\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u",
+                      getCategoryName(it.category), it.phase, double(it.time) / 1000, unsigned(it.thread));
+        os << times;
+        if(it.phase == 'i') os << ",\"s\":\"t\"";
+        if(it.count > 0)
+        {
+            os << ",\"args\":{";
+            for(unsigned i = 0; i < it.count; i++)
+            {
+                char arg[48];
+                if(std::isfinite(it.args[i]))
+                    std::snprintf(arg, sizeof(arg), "%s\"%u\":%.17g", (i > 0) ? "," : "", i, it.args[i]);
+                else
+                    std::snprintf(arg, sizeof(arg), "%s\"%u\":null", (i > 0) ? "," : "", i);
+                os << arg;
+            }
+            os << "}";
+        }
+        os << "}";
+    }
+    os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
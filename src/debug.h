@@ -1,28 +1,37 @@
-
 /**
  * @file debug.h
  * @author xbenes49, xpolan09
  * @date 5 May 2018
  * @brief Debug interface
  *
- * This module supports the debug system in whole project.
+ * This module supports the debug system in whole project. The debug calls
+ * are the trace events of the categories. The categories not compiled in
+ * cost nothing, the others are selected at the run time (Debug::init). The
+ * event keeps the name (string literal) and up to three numbers, it is
+ * formatted only when the trace is dumped. The enabled events are recorded
+ * with the time into the ring buffer of the thread, without any lock, the
+ * oldest events are overwritten. The spans (Debug::Span) mark the begin and
+ * the end of the work, the trace may be written in the Chrome trace format.
  */
 
 
 #ifndef DEBUG_H
 #define DEBUG_H
 
+#include <atomic>
 #include <iostream>
+#include <string>
+#include <vector>
 
-// switches to set debug informations to show
+// switches to compile the categories in (selected by BLOCKEDITOR_TRACE at the run time)
 #ifdef DEBUG_MODE
-    //#define BLOCK_DEBUG
-    //#define MODEL_DEBUG
-    //#define EVENTS_DEBUG
-    //#define GUI_DEBUG
-    //#define CONTROLLER_DEBUG
-    //#define COMPUTE_DEBUG
-    //#define FILE_DEBUG
+    #define BLOCK_DEBUG
+    #define MODEL_DEBUG
+    #define EVENTS_DEBUG
+    #define GUI_DEBUG
+    #define CONTROLLER_DEBUG
+    #define COMPUTE_DEBUG
+    #define FILE_DEBUG
     //...
 #endif // DEBUG_MODE
 
@@ -32,75 +41,226 @@
 namespace Debug
 {
     /**
-     * @brief Block debug.
-     * @param str       String to print.
+     * @brief Categories of the events (bits).
+     */
+    enum Category : unsigned {
+        TraceBlock = 1, /**< Blocks and wires. */
+        TraceModel = 2, /**< Model. */
+        TraceEvents = 4, /**< User events. */
+        TraceGui = 8, /**< Graphics. */
+        TraceController = 16, /**< Controller. */
+        TraceCompute = 32, /**< Computation. */
+        TraceFile = 64 /**< Loading and saving. */
+    };
+
+    /** @brief Categories compiled in. */
+    constexpr unsigned Compiled = 0
+    #ifdef BLOCK_DEBUG
+        | TraceBlock
+    #endif
+    #ifdef MODEL_DEBUG
+        | TraceModel
+    #endif
+    #ifdef EVENTS_DEBUG
+        | TraceEvents
+    #endif
+    #ifdef GUI_DEBUG
+        | TraceGui
+    #endif
+    #ifdef CONTROLLER_DEBUG
+        | TraceController
+    #endif
+    #ifdef COMPUTE_DEBUG
+        | TraceCompute
+    #endif
+    #ifdef FILE_DEBUG
+        | TraceFile
+    #endif
+        ;
+
+    /** @brief Categories enabled at the run time. */
+    inline std::atomic<unsigned> Enabled(0);
+
+    /**
+     * @brief Recorded event.
+     */
+    struct Event {
+        long long time; /**< Time since the start in nanoseconds. */
+        const char* what; /**< Name (string literal). */
+        double args[3]; /**< Numbers. */
+        unsigned char category; /**< Category. */
+        unsigned char count; /**< Count of the numbers. */
+        unsigned short thread; /**< Index of the thread. */
+        char phase; /**< 'i' instant, 'B' begin, 'E' end of the span. */
+    };
+
+    /**
+     * @brief Records the event into the ring buffer of the thread.
+     * @param category  Category.
+     * @param what      Name (string literal).
+     * @param args      Numbers.
+     * @param count     Count of the numbers.
+     * @param phase     'i' instant, 'B' begin, 'E' end of the span.
+     */
+    void record(unsigned category, const char* what, const double* args, unsigned count, char phase = 'i');
+
+    /**
+     * @brief Traces the event, if its category is compiled in and enabled.
+     * @param category  Category.
+     * @param what      Name (string literal).
+     * @param args      Numbers (at most three).
      */
-    inline void Block(std::string str) {
-        #ifdef BLOCK_DEBUG
-            std::cerr << str << "\n";
-        #endif
-        (void)str;
+    template <class... Args>
+    inline void trace(unsigned category, const char* what, Args... args)
+    {
+        static_assert(sizeof...(Args) <= 3, "At most three numbers in the event");
+        if((Compiled & category) == 0) return;
+        if((Enabled.load(std::memory_order_relaxed) & category) == 0) return;
+        const double a[] = {double(args)..., 0};
+        record(category, what, a, sizeof...(Args));
     }
+
+    /**
+     * @brief Span of the work, from the construction to the destruction.
+     */
+    class Span
+    {
+        public:
+            /**
+             * @brief Span constructor. Begins the span, if its category is compiled in and enabled.
+             * @param category  Category.
+             * @param what      Name (string literal).
+             * @param args      Numbers (at most three).
+             */
+            template <class... Args>
+            Span(unsigned category, const char* what, Args... args): mcategory(category), mwhat(what)
+            {
+                static_assert(sizeof...(Args) <= 3, "At most three numbers in the event");
+                if((Compiled & category) == 0) return;
+                if((Enabled.load(std::memory_order_relaxed) & category) == 0) return;
+                const double a[] = {double(args)..., 0};
+                record(category, what, a, sizeof...(Args), 'B');
+                mon = true;
+            }
+            /**
+             * @brief Span destructor. Ends the span.
+             */
+            ~Span() { if(mon) record(mcategory, mwhat, nullptr, 0, 'E'); }
+
+            Span(const Span&) = delete;
+            Span& operator=(const Span&) = delete;
+
+        private:
+            unsigned mcategory; /**< Category. */
+            const char* mwhat; /**< Name. */
+            bool mon = false; /**< Span was begun. */
+    };
+
+    /**
+     * @brief Block debug.
+     * @param what      Name (string literal).
+     * @param args      Numbers.
+     */
+    template <class... Args>
+    inline void Block(const char* what, Args... args) { trace(TraceBlock, what, args...); }
     /**
      * @brief Model debug.
-     * @param str       String to print.
+     * @param what      Name (string literal).
+     * @param args      Numbers.
      */
-    inline void Model(std::string str) {
-        #ifdef MODEL_DEBUG
-            std::cerr << str << "\n";
-        #endif
-        (void)str;
-    }
+    template <class... Args>
+    inline void Model(const char* what, Args... args) { trace(TraceModel, what, args...); }
     /**
      * @brief User events debug.
-     * @param str       String to print.
+     * @param what      Name (string literal).
+     * @param args      Numbers.
      */
-    inline void Events(std::string str) {
-        #ifdef EVENTS_DEBUG
-            std::cerr << str << "\n";
-        #endif
-        (void)str;
-    }
+    template <class... Args>
+    inline void Events(const char* what, Args... args) { trace(TraceEvents, what, args...); }
     /**
      * @brief Graphics debug.
-     * @param str       String to print.
+     * @param what      Name (string literal).
+     * @param args      Numbers.
      */
-    inline void Gui(std::string str) {
-        #ifdef GUI_DEBUG
-            std::cerr << str << "\n";
-        #endif
-        (void)str;
-    }
+    template <class... Args>
+    inline void Gui(const char* what, Args... args) { trace(TraceGui, what, args...); }
     /**
      * @brief Controller debug.
-     * @param str       String to print.
+     * @param what      Name (string literal).
+     * @param args      Numbers.
      */
-    inline void Controller(std::string str) {
-        #ifdef CONTROLLER_DEBUG
-            std::cerr << str << "\n";
-        #endif
-        (void)str;
-    }
+    template <class... Args>
+    inline void Controller(const char* what, Args... args) { trace(TraceController, what, args...); }
     /**
      * @brief Computation debug.
-     * @param str       String to print.
+     * @param what      Name (string literal).
+     * @param args      Numbers.
      */
-    inline void Compute(std::string str) {
-        #ifdef COMPUTE_DEBUG
-            std::cerr << str << "\n";
-        #endif
-        (void)str;
-    }
+    template <class... Args>
+    inline void Compute(const char* what, Args... args) { trace(TraceCompute, what, args...); }
     /**
      * @brief Loading and saving debug.
-     * @param str       String to print.
+     * @param what      Name (string literal).
+     * @param args      Numbers.
      */
-    inline void File(std::string str) {
-        #ifdef FILE_DEBUG
-            std::cerr << str << "\n";
-        #endif
-        (void)str;
-    }
+    template <class... Args>
+    inline void File(const char* what, Args... args) { trace(TraceFile, what, args...); }
+
+    /**
+     * @brief Parses the names of the categories.
+     * @param names     Names separated by commas (block, model, events, gui,
+     *                  controller, compute, file or all).
+     * @returns Categories.
+     */
+    unsigned parse(const std::string& names);
+    /**
+     * @brief Enables the categories at the run time (only the compiled ones take effect).
+     * @param categories    Categories.
+     */
+    void enable(unsigned categories);
+    /**
+     * @brief Enables the categories of the environment variable BLOCKEDITOR_TRACE
+     *        (all of them, if only BLOCKEDITOR_TRACE_FILE is set).
+     */
+    void init();
+    /**
+     * @brief Writes the recorded events at the end, into the file of BLOCKEDITOR_TRACE_FILE
+     *        in the Chrome trace format, or as text to the standard error output.
+     */
+    void finish();
+    /**
+     * @brief Collects the events of all the threads ordered by the time. It should
+     *        be called, when the other threads do not trace.
+     * @returns Events.
+     */
+    std::vector<Event> collect();
+    /**
+     * @brief Forgets the recorded events.
+     */
+    void clear();
+    /**
+     * @brief Name of the category getter.
+     * @param category  Category.
+     * @returns Name.
+     */
+    const char* getCategoryName(unsigned category);
+    /**
+     * @brief Formats the event.
+     * @param e         Event.
+     * @returns Text, the name and the numbers.
+     */
+    std::string format(const Event& e);
+    /**
+     * @brief Prints the recorded events as text.
+     * @param os        Stream.
+     */
+    void dump(std::ostream& os);
+    /**
+     * @brief Writes the recorded events in the Chrome trace format (JSON),
+     *        it opens in chrome://tracing or in Perfetto.
+     * @param os        Stream.
+     */
+    void writeChromeTrace(std::ostream& os);
 }
 
 #endif // DEBUG_H
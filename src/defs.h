@@ -11,10 +11,13 @@
 #ifndef DEFS_H
 #define DEFS_H
 
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <map>
-#include <QPointF>
+#ifndef NO_QT
+    #include <QPointF>
+#endif
 
 /**
  * @brief Type of the error.
@@ -27,6 +30,7 @@ enum ErrorType {
     WireError, /**< Error of a wire. */
     ViewError, /**< Error of a view. */
     NotAnError, /**< Not an error. */
+    Cancelled, /**< Computation cancelled by the user. */
 };
 
 /**
@@ -50,6 +54,8 @@ struct MyError {
         std::string getMessage() { return mmsg; }
         /** @brief Error code getter. */
         int getCode();
+        /** @brief Error type getter. */
+        ErrorType getType() const { return mcode; }
     private:
         std::string mmsg = ""; /**< Error message. */
         ErrorType mcode = ErrorType::Ok; /**< Error code. */
@@ -82,6 +88,8 @@ struct Value {
 struct GuiBlockDescriptor {
     std::pair<double, double> pos; /**< Position of the block in the scene. */
     long type; /**< Type of the placed block. */
+    int ports = 0; /**< Input count of the placed block with N inputs. */
+    bool constant = false; /**< Input does not change between runs. */
     Value val; /**< Value of the placed input block. */
 };
 
@@ -100,6 +108,42 @@ struct wireState {
     int connector2; /**< Connector of the output block. */
 };
 
+/**
+ * @brief Cost of the evaluations of the block (profiling).
+ */
+struct BlockCost {
+    unsigned long long calls = 0; /**< Count of the evaluations. */
+    unsigned long long ns = 0; /**< Time of the evaluations in nanoseconds. */
+    /**
+     * @brief Time of one evaluation.
+     * @returns Nanoseconds per evaluation (0 if none).
+     */
+    double getNsPerCall() const { return (calls > 0) ? double(ns) / double(calls) : 0; }
+};
+
+/**
+ * @brief Progress of the computation, watched and cancelled from another thread.
+ */
+struct ComputeProgress {
+    std::atomic<unsigned long long> done{0}; /**< Count of the finished units (blocks or points). */
+    std::atomic<unsigned long long> total{0}; /**< Count of all the units. */
+    std::atomic<bool> cancelled{false}; /**< Computation should stop. */
+
+    /**
+     * @brief Prepares the progress for the next computation.
+     */
+    void reset() { done = 0; total = 0; cancelled = false; }
+    /**
+     * @brief Asks the computation to stop (it throws MyError with ErrorType::Cancelled).
+     */
+    void cancel() { cancelled = true; }
+    /**
+     * @brief Cancel indicator.
+     * @returns True, if the computation should stop.
+     */
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+};
+
 /**
  * @brief Result of the computation.
  */
@@ -107,6 +151,7 @@ struct Result {
     double value; /**< Result value. */
     std::string type; /**< Result type. */
     int level; /**< Level of the block. */
+    std::string details; /**< Description of the result (statistics), may be empty. */
 
     /**
      * @brief Typecast of Result to Value.
@@ -0,0 +1,39 @@
+/**
+ * @file evaluator.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief background evaluation module
+ *
+ * This module contains the Evaluator implementation.
+ */
+
+#include <exception>
+
+#include "debug.h"
+#include "evaluator.h"
+
+void Evaluator::start(const Job& job)
+{
+    Debug::Controller("Evaluator::start()");
+    mprogress.reset();
+    mjob = job;
+    // the job is passed on by the posted event
+    emit sigStart();
+}
+
+void Evaluator::slotRun()
+{
+    Debug::Span span(Debug::TraceController, "Evaluator::slotRun()");
+    QString error;
+    bool cancelled = false;
+    try { mjob(mprogress); }
+    catch(MyError& e)
+    {
+        if(e.getType() == ErrorType::Cancelled) cancelled = true;
+        else error = QString::fromStdString(e.getMessage());
+    }
+    catch(const char* e) { error = e; }
+    catch(std::exception& e) { error = e.what(); }
+    mjob = nullptr;
+    emit sigFinished(error, cancelled);
+}
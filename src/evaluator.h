@@ -0,0 +1,76 @@
+/**
+ * @file evaluator.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief background evaluation interface
+ *
+ * This module runs the long computations (the run of the scheme, the
+ * statistics) in the thread of the evaluator, so the window stays
+ * responsive. The job reports its progress and checks the cancellation
+ * through the ComputeProgress, the end is signalled back to the thread
+ * of the window by the queued connection.
+ */
+
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include <functional>
+
+#include <QObject>
+#include <QString>
+
+#include "defs.h"
+
+/**
+ * @brief Evaluator. It lives in its own thread (see QObject::moveToThread).
+ */
+class Evaluator: public QObject
+{
+    Q_OBJECT
+    public:
+        /**
+         * @brief Job of the evaluator.
+         * @param progress  Progress of the job.
+         */
+        typedef std::function<void(ComputeProgress& progress)> Job;
+
+        /**
+         * @brief Starts the job in the thread of the evaluator. Called from
+         *        the thread of the window, when no job runs.
+         * @param job       Job.
+         */
+        void start(const Job& job);
+        /**
+         * @brief Asks the running job to stop.
+         */
+        void cancel() { mprogress.cancel(); }
+        /**
+         * @brief Progress getter (may be read from any thread).
+         * @returns Progress of the job.
+         */
+        const ComputeProgress& getProgress() const { return mprogress; }
+
+    public slots:
+        /**
+         * @brief Runs the job (in the thread of the evaluator).
+         */
+        void slotRun();
+
+    signals:
+        /**
+         * @brief Emitted by start(), received in the thread of the evaluator.
+         */
+        void sigStart();
+        /**
+         * @brief Emitted, when the job ends.
+         * @param error     Message of the error (empty, if none).
+         * @param cancelled True, if the job was cancelled.
+         */
+        void sigFinished(QString error, bool cancelled);
+
+    private:
+        Job mjob; /**< Job. */
+        ComputeProgress mprogress; /**< Progress of the job. */
+};
+
+#endif // EVALUATOR_H
@@ -8,6 +8,7 @@
  * This module contains graphical objects implementations.
  */
 
+#include <algorithm>
 #include <iostream>
 
 #include <QInputDialog>
@@ -18,38 +19,62 @@
 #include <QFormLayout>
 #include <QDialogButtonBox>
 #include <QComboBox>
+#include <QCheckBox>
+#include <QStyleOptionGraphicsItem>
 #include <math.h>
 
 #include "debug.h"
 #include "guiblock.h"
 #include "window.h"
 
+namespace {
+    /** @brief Estimated bytes of the private data of QObject (Qt 5, 64 bits). */
+    const size_t ObjectPrivate = 120;
+    /** @brief Estimated bytes of the private data of QGraphicsItem (Qt 5, 64 bits). */
+    const size_t ItemPrivate = 300;
+    /** @brief Estimated bytes of the document, its layout and the text control of QGraphicsTextItem. */
+    const size_t TextPrivate = 6000;
+
+    /**
+     * @brief Adds the characters of the string to the report.
+     * @param r         Report.
+     * @param s         String.
+     */
+    void accountString(MemoryReport& r, const QString& s)
+    {
+        if(s.isEmpty()) return;
+        size_t b = sizeof(QArrayData) + (size_t(s.capacity()) + 1) * sizeof(QChar);
+        r.add("strings", 1, b);
+        r.addAllocation(b);
+    }
+
+    /**
+     * @brief Adds the private data and the tooltip of the item to the report.
+     * @param r         Report.
+     * @param item      Item (it is a QObject too).
+     */
+    void accountItem(MemoryReport& r, const QGraphicsItem& item)
+    {
+        r.add("Qt private data (estimated)", 1, ObjectPrivate + ItemPrivate);
+        accountString(r, item.toolTip());
+    }
+}
+
 
-GuiBlock::GuiBlock(QPointF pos, long type, QGraphicsItem *g):
+GuiBlock::GuiBlock(QPointF pos, long type, int ports, QGraphicsItem *g):
   QGraphicsPixmapItem(g), mtype(type)
 {
-  mrectangle = QRectF(pos.x()-mwidth/2,pos.y()-mheight/2,mwidth,mheight);
-  QPixmap i( QString::fromStdString(Config::getImagePath(
-        Config::getBlockName(mtype)
-    )));
-  i = i.scaledToHeight(mheight);
-  mwidth = i.width();
-  setPixmap(i);
-  setPos(pos.x()-mwidth/2,pos.y()-mheight/2);
+  if(Config::decodeBlockType(type) == BlockType::OneIn_OneOut) mporttype = 1;
+  else if(Config::decodeBlockType(type) == BlockType::TwoIn_OneOut) mporttype = 2;
+  else if(Config::decodeBlockType(type) == BlockType::NIn_OneOut) mporttype = ports;
+  minputs = std::vector<bool>(mporttype, false);
 
-  QRectF port(pos.x()+mwidth/2, pos.y(), 100,100);
+  // blocks with many inputs are taller, up to MaxHeight
+  if(mporttype > 2) mheight = std::max(mheight, std::min(MaxHeight, PortHeight*mporttype));
 
-  if(Config::decodeBlockType(type) == BlockType::OneIn_OneOut)
-  {
-    mporttype = 1;
-    input2 = true;
-    output2 = true;
-  }
-  else if(Config::decodeBlockType(type) == BlockType::TwoIn_OneOut)
-  {
-    mporttype = 2;
-    output2 = true;
-  }
+  mrectangle = QRectF(pos.x()-mwidth/2,pos.y()-mheight/2,mwidth,mheight);
+  setPixmap(loadPixmap(false));
+  setPos(pos.x()-mwidth/2,pos.y()-mheight/2);
 
   mvalue.valid = false;
   setToolTip(QString::fromStdString("Value: Not defined\nType: Not defined"));
@@ -57,10 +82,32 @@ GuiBlock::GuiBlock(QPointF pos, long type, QGraphicsItem *g):
 
   setAcceptDrops(true);
   setAcceptHoverEvents(true);
+  setDetail(true);
+}
+
+QPixmap GuiBlock::loadPixmap(bool highlight)
+{
+  std::string name = Config::getBlockName(mtype);
+  QPixmap i( QString::fromStdString(highlight ? Config::getHLImagePath(name) : Config::getImagePath(name)) );
+  if(mporttype > 2)
+  {
+    // keep the width of the ordinary block, stretch the height
+    mwidth = i.scaledToHeight(60).width();
+    return i.scaled(int(mwidth), int(mheight));
+  }
+  i = i.scaledToHeight(mheight);
+  mwidth = i.width();
+  return i;
 }
 
 void GuiBlock::paint(QPainter *p, const QStyleOptionGraphicsItem *s, QWidget *w)
 {
+  // zoomed out, the image has a few pixels, the plain rectangle is much cheaper
+  if(QStyleOptionGraphicsItem::levelOfDetailFromTransform(p->worldTransform()) < LowDetail)
+  {
+    p->fillRect(QRectF(offset(), QSizeF(pixmap().size())), mglyph);
+    return;
+  }
   QGraphicsPixmapItem::paint(p,s,w);
 }
 
@@ -79,36 +126,16 @@ QPointF GuiBlock::getConnectorPoint(int connector)
     QPointF itemPoint = mrectangle.center();
     QPointF connectorPoint;
 
-    if(mporttype == 2)       // two_in_one_out
+    // inputs are spread evenly along the left side
+    if(connector >= 0 && connector < mporttype)
     {
-        if(connector == 0)
-        {
-            connectorPoint.setX(itemPoint.x() - mwidth/2);
-            connectorPoint.setY(itemPoint.y() - mheight/4);
-        }
-        else if(connector == 1)
-        {
-            connectorPoint.setX(itemPoint.x() - mwidth/2);
-            connectorPoint.setY(itemPoint.y() + mheight/4);
-        }
-        else if(connector == -1)
-        {
-            connectorPoint.setX(itemPoint.x() + mwidth/2);
-            connectorPoint.setY(itemPoint.y());
-        }
+        connectorPoint.setX(itemPoint.x() - mwidth/2);
+        connectorPoint.setY(itemPoint.y() - mheight/2 + (connector+0.5)*mheight/mporttype);
     }
-    else if(mporttype == 1)
+    else if(connector == -1)
     {
-        if(connector == 0)
-        {
-            connectorPoint.setX(itemPoint.x() - mwidth/2);
-            connectorPoint.setY(itemPoint.y());
-        }
-        else if(connector == -1)
-        {
-            connectorPoint.setX(itemPoint.x() + mwidth/2);
-            connectorPoint.setY(itemPoint.y());
-        }
+        connectorPoint.setX(itemPoint.x() + mwidth/2);
+        connectorPoint.setY(itemPoint.y());
     }
     else
     {
@@ -120,113 +147,96 @@ QPointF GuiBlock::getConnectorPoint(int connector)
 
 void GuiBlock::getPointFromBlock(int *connector, bool *wireFree)
 {
-    if(mporttype == 2)       // two_in_one_out
-    {
-        QRectF tempRect1 = QRectF(0.0, 0.0+mheight/8.0, mwidth/2.0, mheight/4.0);
-        QRectF tempRect2 = QRectF(0.0, 0.0+(mheight*5.0)/8.0, mwidth/2.0, mheight/4.0);
-        QRectF tempRect3 = QRectF(0.0+(mwidth)/2.0, 0.0+(mheight)/4.0, mwidth/2.0, mheight/2.0);
+    *wireFree = false;
+    *connector = -2;
+    double band = mheight/mporttype;
 
-        if(tempRect1.contains(MPEvent->pos().x(), MPEvent->pos().y()))
-        {
-            Debug::Gui("levy horni roh itemu");
-            *wireFree = !input1;
-            *connector = 0;
-        }
-        else if(tempRect2.contains(MPEvent->pos().x(), MPEvent->pos().y()))
-        {
-            Debug::Gui("levy dolni roh itemu");
-            *wireFree = !input2;
-            *connector = 1;
-        }
-        else if(tempRect3.contains(MPEvent->pos().x(), MPEvent->pos().y()))
+    // input k: left half, middle half of the k-th band
+    for(int k = 0; k < mporttype; k++)
+    {
+        QRectF tempRect = QRectF(0.0, (k+0.25)*band, mwidth/2.0, band/2.0);
+        if(tempRect.contains(MPEvent->pos().x(), MPEvent->pos().y()))
         {
-            Debug::Gui("pravy roh itemu");
-            *wireFree = !output1;
-            *connector = -1;
+            Debug::Gui("vstup", k);
+            *wireFree = !minputs[k];
+            *connector = k;
+            return;
         }
     }
-    else if(mporttype == 1)      // one_in_one_out
-    {
-        QRectF tempRect1 = QRectF(0.0, 0.0+mheight/4.0, mwidth/2.0, mheight/2.0);
-        QRectF tempRect3 = QRectF(0.0+mwidth/2.0, 0.0+mheight/4.0, mwidth/2.0, mheight/2.0);
 
-        if(tempRect1.contains(MPEvent->pos().x(), MPEvent->pos().y()))
-        {
-            Debug::Gui("levy roh itemu");
-            *wireFree = !input1;
-            *connector = 0;
-        }
-        else if(tempRect3.contains(MPEvent->pos().x(), MPEvent->pos().y()))
+    // packed inputs are too thin to hit, take the free one nearest to the click
+    if(band < PortHeight/2 && MPEvent->pos().x() < mwidth/2.0)
+    {
+        int k = std::min(mporttype-1, std::max(0, int(MPEvent->pos().y()/band)));
+        for(int d = 0; d < mporttype; d++)
         {
-            Debug::Gui("pravy roh itemu");
-            *wireFree = !output1;
-            *connector = -1;
+            for(int c: {k-d, k+d})
+            {
+                if(c < 0 || c >= mporttype || minputs[c]) continue;
+                Debug::Gui("vstup", c);
+                *wireFree = true;
+                *connector = c;
+                return;
+            }
         }
+        *connector = k;     // all connected
+        return;
     }
-    else
+
+    QRectF tempRect = QRectF(0.0+mwidth/2.0, 0.0+mheight/4.0, mwidth/2.0, mheight/2.0);
+    if(tempRect.contains(MPEvent->pos().x(), MPEvent->pos().y()))
     {
-        //std::cout << "error getpointfromblock\n";
+        Debug::Gui("pravy roh itemu");
+        *wireFree = true;   // output fans out
+        *connector = -1;
     }
-
 }
 
 void GuiBlock::setConnectorAvailability(int connector, bool addWire)
 {
-    if(connector == 0)
-    {
-        if(addWire) input1 = true;
-        else input1 = false;
-    }
-    else if(connector == 1)
-    {
-        if(addWire) input2 = true;
-        else input2 = false;
-    }
-    else if(connector == -1)
-    {
-        if(addWire) output1 = true;
-        else output1 = false;
-    }
-    else if(connector == -2)
-    {
-        if(addWire) output2 = true;
-        else output2 = false;
-    }
+    if(connector >= 0 && connector < mporttype) minputs[connector] = addWire;
+    // outputs accept any number of wires
 }
 
 void GuiBlock::setValue(Value v)
 {
     mvalue = v;
-    if(v.valid)
-    {
-        setToolTip(QString::fromStdString("Value: "+std::to_string(mvalue.value)+"\nType: "+mvalue.type));
-    }
-    else
-    {
-        setToolTip(QString::fromStdString("Value: Not defined\nType: Not defined"));
-    }
+    std::string tip;
+    if(v.valid) tip = "Value: "+std::to_string(mvalue.value)+"\nType: "+mvalue.type;
+    else tip = "Value: Not defined\nType: Not defined";
+    if(!mstats.empty()) tip += "\n\n"+mstats;
+    if(!mcost.empty()) tip += "\n\n"+mcost;
+    setToolTip(QString::fromStdString(tip));
 }
 
 void GuiBlock::setColor(bool active)
 {
-    if(active)
-    {
-        QPixmap i( QString::fromStdString(Config::getHLImagePath(
-                    Config::getBlockName(mtype)
-        )));
-        i = i.scaledToHeight(mheight);
-        mwidth = i.width();
-        setPixmap(i);
-    }
-    else
+    mactive = active;
+    updatePixmap();
+}
+
+void GuiBlock::setHeat(double heat, const std::string& cost)
+{
+    mheat = heat;
+    mcost = cost;
+    updatePixmap();
+    setValue(mvalue);
+}
+
+void GuiBlock::updatePixmap()
+{
+    QPixmap p = loadPixmap(mactive);
+    if(mactive) mglyph = Qt::red;
+    else if(mheat >= 0) mglyph = QColor::fromHsvF((1 - mheat) / 3, 1, 0.9);
+    else mglyph = Qt::darkGray;
+    if(mheat >= 0)
     {
-        QPixmap i( QString::fromStdString(Config::getImagePath(
-                    Config::getBlockName(mtype)
-        )));
-        i = i.scaledToHeight(mheight);
-        mwidth = i.width();
-        setPixmap(i);
+        // over the drawn parts of the image only, hue from green to red
+        QPainter painter(&p);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceAtop);
+        painter.fillRect(p.rect(), QColor::fromHsvF((1 - mheat) / 3, 1, 1, 0.3 + 0.4 * mheat));
     }
+    setPixmap(p);
 }
 
 void GuiBlock::hoverEnterEvent(QGraphicsSceneHoverEvent*) {}
@@ -264,7 +274,10 @@ MyWire::MyWire(long id, QPointF point1, QPointF point2, std::shared_ptr<GuiBlock
     QFont font = QFont();
     font.setPixelSize(12);
     mtext->setFont(font);
+    // the layout of the html is expensive to paint
+    mtext->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 
+    createPolyline(point1, point2);
     mvalue.valid = false;
 
 }
@@ -301,7 +314,10 @@ MyWire::MyWire(long id, QPointF point1, QPointF point2, std::shared_ptr<GuiInput
     QFont font = QFont();
     font.setPixelSize(12);
     mtext->setFont(font);
+    // the layout of the html is expensive to paint
+    mtext->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 
+    createPolyline(point1, point2);
     mvalue.valid = false;
 
 }
@@ -337,11 +353,54 @@ MyWire::MyWire(long id, QPointF point1, QPointF point2, std::shared_ptr<GuiBlock
     QFont font = QFont();
     font.setPixelSize(12);
     mtext->setFont(font);
+    // the layout of the html is expensive to paint
+    mtext->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 
+    createPolyline(point1, point2);
     mvalue.valid = false;
 
 }
 
+void GuiBlock::accountMemory(MemoryReport& r, std::set<qint64>& pixmaps) const
+{
+    r.addShared("GuiBlock", sizeof(GuiBlock));
+    accountItem(r, *this);
+    r.addString(mstats);
+    r.addString(mcost);
+    r.addString(mvalue.type);
+    r.addVector("vectors", minputs);
+    QPixmap p = pixmap();
+    if(!p.isNull() && pixmaps.insert(p.cacheKey()).second)
+        r.add("pixmaps", 1, size_t(p.width()) * size_t(p.height()) * size_t(p.depth()) / 8);
+}
+
+void MyWire::accountMemory(MemoryReport& r) const
+{
+    r.addShared("MyWire", sizeof(MyWire));
+    r.add("Qt private data (estimated)", 1, ObjectPrivate);
+    r.addString(mstats);
+    r.addString(mvalue.type);
+    r.addVector("vectors", mLines);
+    for(auto& it: mLines)
+    {
+        r.addShared("MyLine", sizeof(MyLine));
+        accountItem(r, *it);
+    }
+    if(mtext)
+    {
+        r.addShared("text items", sizeof(QGraphicsTextItem));
+        accountItem(r, *mtext);
+        r.add("Qt private data (estimated)", 1, TextPrivate);
+        accountString(r, mtext->toPlainText());
+    }
+    if(mpolyline)
+    {
+        r.addShared("MyPolyline", sizeof(MyPolyline));
+        accountItem(r, *mpolyline);
+        r.add("paths", 1, size_t(mpolyline->path().elementCount()) * sizeof(QPainterPath::Element));
+    }
+}
+
 void MyWire::setColor(bool active)
 {
     for(auto x: mLines)
@@ -356,26 +415,58 @@ void MyWire::setColor(bool active)
             x.get()->setPen(QPen(QBrush(Qt::darkGray, Qt::SolidPattern), 3));
         }
     }
+    // cosmetic pen, one pixel at any zoom
+    mpolyline->setPen(QPen(active ? Qt::red : Qt::darkGray, 0));
+}
+
+void MyWire::setDetail(bool detail)
+{
+    if(mdetail == detail) return;
+    mdetail = detail;
+    for(auto& it: mLines) { it->setVisible(detail); }
+    mtext->setVisible(detail);
+    mpolyline->setVisible(!detail);
+    // the hidden text was not updated
+    if(detail) updateText();
+}
+
+void MyWire::createPolyline(QPointF point1, QPointF point2)
+{
+    QPainterPath path(point1);
+    for(auto& it: MyWire::splitLine(point1, point2)) { path.lineTo(it.second); }
+    mpolyline = std::make_shared<MyPolyline>(path);
+    mpolyline->setPen(QPen(Qt::darkGray, 0));
+    mpolyline->setVisible(false);
+    QObject::connect(mpolyline.get(), SIGNAL(sigForkWire(QPointF)),
+                    this, SLOT(slotForkWire(QPointF)));
+    QObject::connect(mpolyline.get(), SIGNAL(sigDeleteWire()),
+                    this, SLOT(slotDeleteWire()));
+}
+
+void MyWire::updateText()
+{
+    if(mvalue.valid) mtext->setHtml(QString::fromStdString("<center>"+std::to_string(mvalue.value)+"</center>"/*+" "+v.type*/));
+    else mtext->setHtml("<center>N</center>");
 }
 
 void MyWire::setValue(Value v)
 {
     mvalue = v;
+    if(mdetail) updateText();
     if(v.valid)
     {
-        mtext->setHtml(QString::fromStdString("<center>"+std::to_string(v.value)+"</center>"/*+" "+v.type*/));
-        //mtext->setPlainText(QString::fromStdString(std::to_string(v.value)/*+" "+v.type*/));
         for(auto& it: mLines)
         {
-            it.get()->setToolTip(QString::fromStdString("Value: "+std::to_string(mvalue.value)+"\nType: "+mvalue.type));
+            it.get()->setToolTip(QString::fromStdString("Value: "+std::to_string(mvalue.value)+"\nType: "+mvalue.type
+                                                        +(mstats.empty() ? "" : "\n\n"+mstats)));
         }
     }
     else
     {
-        mtext->setHtml("<center>N</center>");
         for(auto& it: mLines)
         {
-            it.get()->setToolTip(QString::fromStdString("Value: Not defined\nType: Not defined"));
+            it.get()->setToolTip(QString::fromStdString("Value: Not defined\nType: Not defined"
+                                                        +(mstats.empty() ? "" : "\n\n"+mstats)));
         }
     }
 }
@@ -409,7 +500,7 @@ GuiInput::GuiInput(QPointF pos, bool load, QGraphicsItem* g):
         getUserValue(&mvalue.value, mvalue.type, &mok);
         mvalue.valid = true;
 
-        setToolTip(QString::fromStdString("Value: "+std::to_string(mvalue.value)+"\nType: "+mvalue.type));
+        updateToolTip();
     }
     else
     {
@@ -421,6 +512,7 @@ GuiInput::GuiInput(QPointF pos, bool load, QGraphicsItem* g):
 
     setAcceptDrops(true);
     setAcceptHoverEvents(true);
+    setDetail(true);
 }
 
 
@@ -446,6 +538,11 @@ void GuiInput::getUserValue(double *value, std::string &type, bool *mok)
     }
     form.addRow(label2, &box);
 
+    QCheckBox constant("Constant");
+    constant.setChecked(mconstant);
+    constant.setToolTip("Value does not change between runs (it is folded in the plan)");
+    form.addRow(&constant);
+
     QPushButton *okButton = new QPushButton("Ok");
     okButton->setDefault(true);
     okButton->setFixedHeight(30);
@@ -481,6 +578,7 @@ void GuiInput::getUserValue(double *value, std::string &type, bool *mok)
         }
         typeIdx = box.currentIndex();
         type = box.itemText(typeIdx).toStdString();
+        mconstant = constant.isChecked();
         //std::cout << *value << " " << typeIdx << std::endl;
         *mok = true;
     }
@@ -488,6 +586,21 @@ void GuiInput::getUserValue(double *value, std::string &type, bool *mok)
 
 }
 
+void GuiInput::updateToolTip()
+{
+    setToolTip(QString::fromStdString("Value: "+std::to_string(mvalue.value)+"\nType: "+mvalue.type
+                                      +(mconstant ? "\nConstant" : "")
+                                      +(mstats.empty() ? "" : "\n\n"+mstats)));
+}
+
+void GuiInput::accountMemory(MemoryReport& r) const
+{
+    r.addShared("GuiInput", sizeof(GuiInput));
+    accountItem(r, *this);
+    r.addString(mstats);
+    r.addString(mvalue.type);
+}
+
 void GuiInput::mousePressEvent(QGraphicsSceneMouseEvent* event)
 {
     MPEvent = event;
@@ -512,7 +625,7 @@ void GuiInput::mouseDoubleClickEvent(QGraphicsSceneMouseEvent* event)
         emit sigValueChanged();
         //std::cout << mvalue.value << " " << mvalue.type << std::endl;
 
-        setToolTip(QString::fromStdString("Value: "+std::to_string(mvalue.value)+"\nType: "+mvalue.type));
+        updateToolTip();
     }
 }
 
@@ -521,6 +634,12 @@ void GuiInput::hoverLeaveEvent(QGraphicsSceneHoverEvent *) {}
 
 void GuiInput::paint(QPainter *p, const QStyleOptionGraphicsItem *s, QWidget *w)
 {
+  // zoomed out, the plain square is enough
+  if(QStyleOptionGraphicsItem::levelOfDetailFromTransform(p->worldTransform()) < GuiBlock::LowDetail)
+  {
+    p->fillRect(rect(), brush());
+    return;
+  }
   QGraphicsEllipseItem::paint(p,s,w);
 }
 
@@ -538,11 +657,7 @@ QPointF GuiInput::getConnectorPoint(int)
 void GuiInput::getPointFromBlock(int *connector, bool *wireFree)
 {
     *connector = -1;
-    *wireFree = !output1;
+    *wireFree = true;   // output fans out
 }
 
-void GuiInput::setConnectorAvailability(int, bool addWire)
-{
-    if(addWire) output1 = true;
-    else output1 = false;
-}
+void GuiInput::setConnectorAvailability(int, bool) {}
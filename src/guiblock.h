@@ -13,7 +13,9 @@
 
 #include <iostream>
 #include <memory>
+#include <set>
 #include <string>
+#include <vector>
 
 #include <QWidget>
 #include <QPainter>
@@ -21,6 +23,8 @@
 #include <QGraphicsRectItem>
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsEllipseItem>
+#include <QGraphicsPathItem>
+#include <QPainterPath>
 #include <QPointF>
 #include <QRectF>
 #include <QBrush>
@@ -29,6 +33,7 @@
 #include <QToolTip>
 
 #include "defs.h"
+#include "memoryreport.h"
 
 /**
  * @brief Graphical block.
@@ -39,8 +44,16 @@ class GuiBlock: public QObject, public QGraphicsPixmapItem
   public:
     /**
      * @brief GuiBlock constructor.
+     * @param pos       Position of the block.
+     * @param type      Type of the block.
+     * @param ports     Count of inputs (only for blocks with N inputs).
+     * @param g         Parent.
      */
-    GuiBlock(QPointF, long, QGraphicsItem* g = 0);
+    GuiBlock(QPointF, long, int ports = 0, QGraphicsItem* g = 0);
+
+    static constexpr double LowDetail = 0.4; /**< Zoom, under which the items are simplified. */
+    static constexpr double PortHeight = 20;  /**< Height of one input of a block with many inputs. */
+    static constexpr double MaxHeight = 600;  /**< Height, over which the inputs are packed closer. */
 
     /**
      * @brief   Gets type of the block.
@@ -57,6 +70,11 @@ class GuiBlock: public QObject, public QGraphicsPixmapItem
      * @returns Height of the block.
      */
     long getHeight() { return mheight; }
+    /**
+     * @brief   Input count getter.
+     * @returns Count of the inputs of the block.
+     */
+    int getInputCount() { return mporttype; }
 
     /**
      * @brief   Function that paints the block.
@@ -110,7 +128,7 @@ class GuiBlock: public QObject, public QGraphicsPixmapItem
     QPointF getConnectorPoint(int);
 
     /**
-     * @brief   Sets connector availability.
+     * @brief   Sets connector availability. Output connector is always available.
      * @param   connector   integer representing connector
      * @param   addWire     true -> set not available, false -> set available
      */
@@ -119,18 +137,41 @@ class GuiBlock: public QObject, public QGraphicsPixmapItem
     /**
      * @brief   Prints connector availability of a block. Debug function.
      */
-    void printCon() { std::cout << input1<<input2<<output1<<output2<<"\n"; }
+    void printCon() { for(bool b: minputs) std::cout << b; std::cout << "\n"; }
 
     /**
      * @brief   Value setter
      * @param v         Value to set.
      */        
     void setValue(Value v);
+    /**
+     * @brief   Statistics setter (shown in the tooltip).
+     * @param s         Description of the statistics (empty to hide).
+     */
+    void setStats(const std::string& s) { mstats = s; setValue(mvalue); }
     /**
      * @brief   Color setter.
      * @param active    True, if highlight.
      */
     void setColor(bool active);
+    /**
+     * @brief   Heat setter (profiling). Tints the image from green (cheap) to red (expensive).
+     * @param heat      Relative cost in [0,1], negative to remove the tint.
+     * @param cost      Description of the cost (shown in the tooltip).
+     */
+    void setHeat(double heat, const std::string& cost);
+    /**
+     * @brief   Detail setter. The detailed block is cached in the device
+     *          coordinates, the simplified one is painted directly.
+     * @param detail    True, if zoomed over LowDetail.
+     */
+    void setDetail(bool detail) { setCacheMode(detail ? DeviceCoordinateCache : NoCache); }
+    /**
+     * @brief   Adds the memory of the block to the report.
+     * @param r         Report.
+     * @param pixmaps   Keys of the pixmaps counted already (shared pixmaps are counted once).
+     */
+    void accountMemory(MemoryReport& r, std::set<qint64>& pixmaps) const;
     // ----------------------------
 
   signals:
@@ -140,6 +181,17 @@ class GuiBlock: public QObject, public QGraphicsPixmapItem
     void sigBlockClick();
 
   private:
+    /**
+     * @brief   Loads the image of the block, scaled to the block size.
+     * @param highlight     True, if the highlighted image.
+     * @returns Scaled image.
+     */
+    QPixmap loadPixmap(bool highlight);
+    /**
+     * @brief Sets the image by the highlight and the heat.
+     */
+    void updatePixmap();
+
     QRectF mrectangle;      /**< Rectangle of the block. */
     double mwidth = 30;     /**< Width of the block. */
     double mheight = 60;    /**< Height of the block. */
@@ -148,17 +200,18 @@ class GuiBlock: public QObject, public QGraphicsPixmapItem
 
     // different blocks variables - I/O
     long mtype;     /**< Type of the block. */
-    long mporttype; /**< Port type of the block. */
+    int mporttype; /**< Port type of the block (count of inputs). */
     Value mvalue;   /**< Assigned value. */
+    std::string mstats; /**< Statistics of the runs. */
+    bool mactive = false; /**< Highlighted. */
+    double mheat = -1; /**< Relative cost (negative if not profiled). */
+    std::string mcost; /**< Description of the cost. */
+    QColor mglyph = Qt::darkGray; /**< Color of the simplified block. */
 
     QBrush blockBrush;  /**< Brush. */
     QPen blockPen;      /**< Pen. */
 
-    /**< Input and output connector availability. */
-    bool input1 = false;    /**< Availability of input 1. */
-    bool input2 = false;    /**< Availability of input 2. */
-    bool output1 = false;   /**< Availability of output 1. */
-    bool output2 = false;   /**< Availability of output 2. */
+    std::vector<bool> minputs; /**< Input connector availability (output fans out, it is always available). */
 };
 
 /**
@@ -199,6 +252,43 @@ class MyLine: public QObject, public QGraphicsLineItem
         void sigDeleteWire();
 };
 
+/**
+ * @brief Polyline, whole wire in one item (drawn, when zoomed out).
+ */
+class MyPolyline: public QObject, public QGraphicsPathItem
+{
+    Q_OBJECT
+
+    public:
+        /**
+         * @brief MyPolyline constructor.
+         * @param path      Path of the wire.
+         * @param parent    Parent.
+         */
+        MyPolyline(const QPainterPath& path, QGraphicsItem* parent = 0):
+            QGraphicsPathItem(path, parent) {}
+
+        /**
+         * @brief   Mouse press handler.
+         * @param event     Description of event.
+         */
+        void mousePressEvent(QGraphicsSceneMouseEvent* event)
+        {
+            if(event->button() == Qt::LeftButton) { emit sigForkWire(event->pos()); }
+            else if(event->button() == Qt::RightButton) { emit sigDeleteWire(); }
+        }
+
+    signals:
+        /**
+         * @brief Fork the wire.
+         */
+        void sigForkWire(QPointF);
+        /**
+         * @brief Delete the wire.
+         */
+        void sigDeleteWire();
+};
+
 class GuiInput;
 
 /**
@@ -252,6 +342,11 @@ class MyWire: public QObject
          * @returns Text.
          */
         QGraphicsTextItem *getText() { return mtext.get(); }
+        /**
+         * @brief Polyline getter.
+         * @returns Polyline (shown instead of the lines, when zoomed out).
+         */
+        MyPolyline *getPolyline() { return mpolyline.get(); }
 
         /**
          * @brief Input1 getter.
@@ -300,11 +395,27 @@ class MyWire: public QObject
          * @param v     New value.
          */
         void setValue(Value v);
+        /**
+         * @brief Statistics setter (shown in the tooltip).
+         * @param s     Description of the statistics (empty to hide).
+         */
+        void setStats(const std::string& s) { mstats = s; setValue(mvalue); }
         /**
          * @brief Highlights the wire, if active is true.
          * @param active        Set highlighted, if active is true.
          */
         void setColor(bool active);
+        /**
+         * @brief Detail setter. Zoomed out, the lines and the text are hidden
+         *        and the polyline is shown.
+         * @param detail        True, if zoomed over GuiBlock::LowDetail.
+         */
+        void setDetail(bool detail);
+        /**
+         * @brief Adds the memory of the wire, its lines and its text to the report.
+         * @param r         Report.
+         */
+        void accountMemory(MemoryReport& r) const;
 
     public slots:
         /**
@@ -332,9 +443,12 @@ class MyWire: public QObject
 
     private:
         Value mvalue; /**< Value, that wire has. */
+        std::string mstats; /**< Statistics of the runs. */
         long mid; /**< ID of the wire. */
         std::vector<std::shared_ptr<MyLine>> mLines; /**< Lines, wire is composed from. */
         std::shared_ptr<QGraphicsTextItem> mtext; /**< Text over the wire. */
+        std::shared_ptr<MyPolyline> mpolyline; /**< Whole wire (zoomed out). */
+        bool mdetail = true; /**< Lines and text shown. */
         std::shared_ptr<GuiInput> iblock1 = nullptr; /**< Start input. */
         std::shared_ptr<GuiBlock> gblock1 = nullptr; /**< Start block. */
         std::shared_ptr<GuiInput> iblock2 = nullptr; /**< End input. */
@@ -351,6 +465,16 @@ class MyWire: public QObject
          * @returns Vector of lines, that represent the split.
          */
         static std::vector<std::pair<QPointF,QPointF>> splitLine(QPointF, QPointF);
+        /**
+         * @brief Creates the polyline (hidden) for the given start and end.
+         * @param start         Start point.
+         * @param end           End point.
+         */
+        void createPolyline(QPointF, QPointF);
+        /**
+         * @brief Sets the text over the wire by the value.
+         */
+        void updateText();
 
 };
 
@@ -378,7 +502,32 @@ class GuiInput: public QObject, public QGraphicsEllipseItem
          * @brief Value setter.
          * @param v         New value.
          */
-        void setValue(Value v) { mvalue = v; setToolTip(QString::fromStdString("Value: "+std::to_string(mvalue.value)+"\nType: "+mvalue.type));}
+        void setValue(Value v) { mvalue = v; updateToolTip(); }
+        /**
+         * @brief Constant flag getter.
+         * @returns True, if the input does not change between runs.
+         */
+        bool isConstant() { return mconstant; }
+        /**
+         * @brief Constant flag setter.
+         * @param constant  True, if the input does not change between runs.
+         */
+        void setConstant(bool constant) { mconstant = constant; updateToolTip(); }
+        /**
+         * @brief Statistics setter (shown in the tooltip).
+         * @param s         Description of the statistics (empty to hide).
+         */
+        void setStats(const std::string& s) { mstats = s; updateToolTip(); }
+        /**
+         * @brief Detail setter (see GuiBlock::setDetail).
+         * @param detail    True, if zoomed over GuiBlock::LowDetail.
+         */
+        void setDetail(bool detail) { setCacheMode(detail ? DeviceCoordinateCache : NoCache); }
+        /**
+         * @brief Adds the memory of the input to the report.
+         * @param r         Report.
+         */
+        void accountMemory(MemoryReport& r) const;
 
         /**
          * @brief   Mouse press handler.
@@ -453,7 +602,8 @@ class GuiInput: public QObject, public QGraphicsEllipseItem
          */
         QPointF getConnectorPoint(int connector);
         /**
-         * @brief   Sets connector availability.
+         * @brief   Sets connector availability. Input has only output connector,
+         *          which fans out, so it is always available.
          * @param   connector   integer representing connector
          * @param   addWire     true -> set not available, false -> set available
          */
@@ -480,13 +630,18 @@ class GuiInput: public QObject, public QGraphicsEllipseItem
          * @brief Shows the dialog with the value.
          */
         void showValueDialog();
+        /**
+         * @brief Sets the tooltip with the value.
+         */
+        void updateToolTip();
 
         Value mvalue; /**< Value. */
+        bool mconstant = false; /**< Input does not change between runs. */
+        std::string mstats; /**< Statistics of the runs. */
         int mporttype = -1; /**< Type of the ports (block specific). */
         double mradius = 30; /**< Radius. */
         bool mok;   /**< Status of input. */
         QPointF positionCenter; /**< Center point. */
-        bool output1 = false; /**< Output status. */
 
         QGraphicsSceneMouseEvent * MPEvent = nullptr; /**< Last mouse event. */
 
@@ -0,0 +1,36 @@
+/**
+ * @file headless.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief build without Qt
+ *
+ * This module replaces the parts of the Qt object system, the model uses,
+ * when it is built without Qt (NO_QT defined), for example by the benchmarks.
+ * The signals are plain methods, which do nothing.
+ */
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#ifdef NO_QT
+    #define Q_OBJECT
+    #define signals public
+    #define slots
+    #define emit
+
+    /**
+     * @brief Base of the objects (no signals, no slots).
+     */
+    class QObject
+    {
+        public:
+            /**
+             * @brief QObject destructor.
+             */
+            virtual ~QObject() {}
+    };
+#else
+    #include <QObject>
+#endif // NO_QT
+
+#endif // HEADLESS_H
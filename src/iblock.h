@@ -12,9 +12,12 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 #include "defs.h"
 #include "debug.h"
+#include "memoryreport.h"
+#include "valuestore.h"
 
 class Wire;
 
@@ -27,28 +30,35 @@ class IBlock
         /**
          * @brief IBlock constructor.
          * @param id        ID of the block.
+         * @param store     Value storage of the scheme.
          * @param type      Type of the block.
          */
-        IBlock(long id, long type = -1): mid(id), mtype(type) {}
+        IBlock(long id, ValueStore& store, long type = -1):
+            mid(id), mtype(type), mstore(store), mslot(store.allocate()) {}
         /**
-         * @brief IBlock destructor.
+         * @brief IBlock destructor. Releases the slot.
          */
-        virtual ~IBlock() {}
+        virtual ~IBlock() { mstore.release(mslot); }
 
         /**
          * @brief Value getter.
          * @returns The block value.
          */
-        virtual Value getValue() const { return mvalue; }
+        virtual Value getValue() const { return mstore.get(mslot); }
         /**
          * @brief Value setter.
          * @param value     Assigned value.
          */
-        virtual void setValue(const Value& value) { mvalue = value; }
+        virtual void setValue(const Value& value) { mstore.put(mslot, value); }
         /**
          * @brief Value resetter.
          */
-        void resetValue() { Value v; setValue(v); }
+        void resetValue() { mstore.invalidate(mslot); }
+        /**
+         * @brief Slot getter.
+         * @returns Slot of the block output in the value storage.
+         */
+        long getSlot() const { return mslot; }
 
         /**
          * @brief Level setter.
@@ -66,6 +76,16 @@ class IBlock
          * @returns The type value.
          */
         long getType() const { return mtype; }
+        /**
+         * @brief Input port count getter.
+         * @returns Count of the input ports.
+         */
+        virtual int getInputCount() const { return 0; }
+        /**
+         * @brief Getter of the slots, the block reads its inputs from.
+         * @returns Slots of the input ports (-1 for unconnected port).
+         */
+        virtual std::vector<long> getInputSlots() const { return std::vector<long>(); }
 
         /**
          * @brief Propagates level towards.
@@ -87,7 +107,7 @@ class IBlock
          * @brief Removes a single wire key.
          * @param key       Key of wire to remove.
          */
-        virtual void removeWireKey(long key) { Debug::Block("IBlock::removeWireKey("+std::to_string(key)+")"); mkeys.erase(key); }
+        virtual void removeWireKey(long key) { Debug::Block("IBlock::removeWireKey()", key); mkeys.erase(key); }
         /**
          * @brief Getter of keys of associated wires.
          * @returns Set of keys.
@@ -99,6 +119,16 @@ class IBlock
          * @returns True, weather the block is input, false otherwise.
          */
         virtual bool isInput() { return false; }
+        /**
+         * @brief Constant indicator.
+         * @returns True, if the value of the block does not change between runs.
+         */
+        virtual bool isConstant() const { return false; }
+        /**
+         * @brief Marks the block as constant or variable.
+         * @param c         True, if constant.
+         */
+        virtual void setConstant(bool) {}
 
         /**
          * @brief Distributes the result forward. It is overriden in the child classes.
@@ -113,13 +143,35 @@ class IBlock
          */
         virtual SimulationResults& distributeResult(SimulationResults& r) { return r; }
 
-    protected:
         /**
          * @brief ID getter.
          * @returns ID.
          */
         long getId() const { return mid; }
 
+        /**
+         * @brief Cost getter.
+         * @returns Cost of the evaluations since the last reset.
+         */
+        const BlockCost& getCost() const { return mcost; }
+        /**
+         * @brief Adds the evaluation to the cost.
+         * @param ns        Time of the evaluation in nanoseconds.
+         */
+        void addCost(unsigned long long ns) { mcost.calls++; mcost.ns += ns; }
+        /**
+         * @brief Forgets the cost.
+         */
+        void resetCost() { mcost = BlockCost(); }
+
+        /**
+         * @brief Adds the memory of the block (made by std::make_shared)
+         *        and of its ports to the report.
+         * @param r         Report.
+         */
+        virtual void accountMemory(MemoryReport& r) const { r.addMap(mkeys); }
+
+    protected:
         /**
          * @brief Input port indicator.
          * @param p         Port to test.
@@ -133,12 +185,20 @@ class IBlock
          */
         static bool isOutputPort(int p) { return p < 0; }
 
+        /**
+         * @brief Value storage getter.
+         * @returns Value storage of the scheme.
+         */
+        ValueStore& getStore() const { return mstore; }
+
     private:
         long mid; /**< ID of the block. */
         long mtype; /**< Type of the block. */
 
-        Value mvalue; /**< Value, that a block counted/has. */
+        ValueStore& mstore; /**< Storage of the values. */
+        long mslot; /**< Slot, where the block keeps its value. */
         int mlevel = -1; /**< Level of the block in the scheme. */
+        BlockCost mcost; /**< Cost of the evaluations (profiling). */
 
         std::map<long,int> mkeys; /**< Keys of the wires connected () */
 };
@@ -1,7 +1,7 @@
 
 
-SOURCES = main.cpp defs.cpp controller.cpp playground.cpp guiblock.cpp config.cpp window.cpp model.cpp menu.cpp
-HEADERS = defs.h controller.h config.h debug.h playground.h guiblock.h window.h block.h wire.h iblock.h model.h menu.h
+SOURCES = main.cpp defs.cpp controller.cpp playground.cpp guiblock.cpp config.cpp window.cpp model.cpp menu.cpp plan.cpp program.cpp codegen.cpp native.cpp autodiff.cpp scheme.cpp sweep.cpp stats.cpp cli.cpp debug.cpp analysis.cpp memoryreport.cpp evaluator.cpp
+HEADERS = defs.h controller.h config.h debug.h playground.h guiblock.h window.h block.h wire.h iblock.h model.h menu.h valuestore.h plan.h program.h codegen.h native.h autodiff.h scheme.h sweep.h stats.h cli.h headless.h profile.h analysis.h memoryreport.h evaluator.h
 
 TARGET = blockeditor
 
@@ -9,6 +9,7 @@ TARGET = blockeditor
 CONFIG += qt debug
 QT += widgets
 LIBS += -lm
+unix: LIBS += -ldl
 QMAKE_CXXFLAGS += -std=c++17 -Wall -Wextra -pedantic -DDEBUG_MODE
 
 
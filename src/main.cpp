@@ -12,8 +12,10 @@
 #include <QApplication>
 #include <QPushButton>
 
+#include "cli.h"
 #include "config.h"
 #include "controller.h"
+#include "debug.h"
 
 /**
  * @brief Applies the style to the application.
@@ -37,16 +39,27 @@ int main(int argc, char *argv[])
 {
     // init config
     Config::initConfig();
+    Debug::init();
 
-    // init qapp
-    QApplication app (argc, argv);
-    setAppStyle(app);
+    // command line modes, without the window
+    int code;
+    if(Cli::isHeadless(argc, argv)) code = Cli::run(argc, argv);
+    else
+    {
+        // init qapp
+        QApplication app (argc, argv);
+        setAppStyle(app);
 
-    // init model
-    Controller c;
+        // init model
+        Controller c;
 
-    // run
-    return app.exec();
+        // run
+        code = app.exec();
+    }
+
+    // recorded trace
+    Debug::finish();
+    return code;
 }
 
 
@@ -59,18 +72,21 @@ int main(int argc, char *argv[])
  *
  * \subsection Blocks
  * After you start the application, you will see a neat menu on the left side and a play ground on the right side.
- * Use the menu to choose from eleven different blocks by left-clicking the block icon and then left-clicking
+ * Use the menu to choose from fifteen different blocks by left-clicking the block icon and then left-clicking
  * the free space. Each block type performs a different operation displayed by an intuitive icon.
+ * The sum, product, min and max blocks reduce any number of inputs. When placing them, a dialog asks
+ * for the count of their inputs.
  * Remember to place your blocks further from each other due to anti-collision detection. Blocks cannot
  * be too close to each other. In order to delete blocks just simply right-click them and they will disappear
  * together with all wires connected to them.
  *
  * \subsection Wires
- * Each block (apart from input blocks, about them later) requires either one or two input wires and allows
- * you to connect one output wire. The whole playground is situated left-to-right, the inputs are the ones on the
+ * Each block (apart from input blocks, about them later) requires one, two or the chosen count of input wires and allows
+ * you to connect any number of output wires. The result of the block is computed once and read by all of
+ * them. The whole playground is situated left-to-right, the inputs are the ones on the
  * left of the box. In order to place a wire, choose "wire" in the menu and then left-click
  * two connectors of two different blocks. Wires can only connect output connectors with input ones and
- * do not allow you to use one connector multiple times. If any action violates these rules, nothing will happen.
+ * do not allow you to use one input connector multiple times. If any action violates these rules, nothing will happen.
  * Wires can be deleted, as well as blocks, by right-clicking them or removing any adjacent block.
  *
  * \subsection Inputs
@@ -90,6 +106,10 @@ int main(int argc, char *argv[])
  * To perform computation choose "run" option from top bar and then "compute". This will compute everything. If you desire
  * to enjoy the computation step by step press "run" -> "debug" option and use your spacebar to move forward. To interrupt
  * debugging press escape. Progress of the debugging will be highlighted with red color.
+ * "run" -> "play" shows the results level by level, driven by the timer. The levels due since the last
+ * frame are shown together, so the scene is repainted at most once per frame. "run" -> "pause" (or P)
+ * pauses and resumes the playback, "run" -> "playback speed" sets the levels and the frames per second,
+ * + and - make it twice faster or slower.
  * 
  * \image html debug.png "Debug mode"
  *
@@ -129,13 +149,100 @@ int main(int argc, char *argv[])
  * discrete time value, when they are going to have result during evaluation). The distribute it
  * through the wires. During this process, they also detect possible loops in the scheme and prevent it.
  * 
+ * The values of the blocks are not kept in the blocks themselves. The Model owns a ValueStore,
+ * which holds the values, validity bits and type ids of all the blocks in parallel arrays.
+ * Every block owns a slot there, and every connected input Port keeps the slot of the block
+ * it reads from, so the inputs are read directly from the storage.
+ * 
  * When the computation is initialized, the Model provides its results in advance. Every input returns
  * the structure with results, it may provide, and afterwards, they all are merged together.
  * When debugging, the vector is simply iterated on spacebar event.
  * 
+ * For evaluating many rows of inputs at once, the Model builds a Plan, a flat list of the blocks
+ * ordered by their levels. It evaluates the rows column by column. The block functions do not
+ * throw, they return the value together with an error code. The erroneous value poisons the values
+ * depending on it, and the rows and the blocks with errors are reported by masks at the end. The
+ * interactive computation throws the error of the function, as before. Inputs may be marked
+ * constant in the input dialog. Blocks depending only on constants are evaluated once, when the
+ * plan is built, and blocks not leading to the selected outputs are dropped from the plan. Simple
+ * algebraic identities of the built-in blocks (double negation, multiplication by one, sqrt of
+ * squared value and so on) are rewritten as well, the plan keeps the IDs of the original blocks.
+ * Identical blocks (same type reading the same values) are evaluated only once. When the outputs
+ * are selected, chains of the blocks with one input are fused into one node, which does not store
+ * the values between the blocks.
+ * 
+ * The plan may be compiled into a register bytecode (Program), one instruction per block over
+ * a register file. It is evaluated by a simple loop without allocations and it can be exported
+ * (File, Export program) into a text file, that is loaded and run without building the blocks.
+ * The scheme may be also exported (File, Export C++) as a standalone C++ header with a straight
+ * line function eval(inputs, outputs, errors), which uses the same math as the blocks.
+ * The NativeEngine compiles this header by the system compiler into a shared object in the
+ * background and loads it, the bytecode is interpreted meanwhile. The shared objects are cached
+ * on the disk by the hash of the source.
+ * The derivatives of the outputs by the selected inputs are evaluated by ForwardDiff in one pass
+ * over the program, every register carries the value and one derivative per selected input.
+ * For many inputs and one output, ReverseDiff records the local derivatives of the instructions
+ * on a tape of fixed size and sweeps it backwards, giving the whole gradient in one pass.
+ * 
+ * 
+ * The scheme may be evaluated without the window, over many values of the chosen inputs
+ * (blockeditor --sweep scheme.bsc --param ID=A:B:STEPS ...). The Sweep makes the points of a grid,
+ * a Latin hypercube or Monte Carlo samples from their index, evaluates them by the program in
+ * batches on all the cores and prints them as CSV, batch after batch in the order of the points.
+ * From 100000 points, the batches are evaluated by the native code of the NativeEngine as soon as
+ * it is loaded (--interpret keeps the bytecode).
+ * With --stats, it prints only the statistics of the outputs. The StatsCollector keeps the mean,
+ * the variance, the minimum, the maximum, the histogram and the quantile sketch of the attached
+ * blocks and wires, every thread fills its own one and they are merged at the end. In the GUI,
+ * "run" -> "statistics" evaluates the scheme with the inputs spread randomly around their values
+ * and shows the statistics in the tooltips of the blocks and the wires.
+ * 
+ * "run" -> "critical path" (or blockeditor --analyze scheme.bsc [--profile RUNS]) finds the chain
+ * of the blocks with the largest sum of the costs and highlights it. The costs are measured by
+ * the profiling, the blocks not measured take the mean of their type or the estimate of the type.
+ * The work divided by the critical path bounds the speedup of any parallel evaluation, the widths
+ * of the levels show, how many blocks may be evaluated at once.
+ * 
+ * "run" -> "memory usage" (or blockeditor --memory scheme.bsc, the model only) sums the memory of the
+ * model (the blocks, the ports, the wires, the nodes of the maps, the control blocks of shared_ptr,
+ * the strings and the vectors) and of the scene (the items, the pixmaps, the lines and the texts of
+ * the wires) with the overhead of the allocator. The private data of Qt are estimated.
+ * 
+ * The computation and the statistics run in the thread of the Evaluator, the window stays responsive
+ * to the panning and the zooming meanwhile (the editing is blocked by the compute mode). The progress
+ * bar shows the evaluated blocks (or the points of the sweep), "run" -> "cancel" or escape stops the
+ * computation after the current block (or batch). The end of the job is passed to the Controller by
+ * the queued connection and the results are shown in the thread of the window.
+ * 
+ * The play ground is zoomed by Ctrl and the mouse wheel. Under the zoom GuiBlock::LowDetail, the blocks
+ * are painted as plain rectangles in the color of their state (the inputs as white squares), every wire is one polyline with the
+ * cosmetic pen instead of three lines and its text with the value is hidden (and not updated). Over it,
+ * the blocks, the inputs and the texts of the wires are cached in the device coordinates, so the panning only
+ * copies their images.
+ * 
  * When saving, the Model and the Window provide its states and the Controller then saves it to the file.
  * When reading, the read information are propagated to the Model and the Window, when the objects are
- * generated.
+ * generated. The file itself is read and written by the Scheme functions, which do not need the window.
+ * 
+ * The debug calls record the events of their categories (block, model, events, gui, controller,
+ * compute, file) with the time into the ring buffer of the thread. The categories are compiled in
+ * by the switches in debug.h (all of them in the debug mode) and selected at the run time by the
+ * environment variable BLOCKEDITOR_TRACE (for example "block,compute" or "all"), the events are
+ * printed at the end. The event keeps only the name and the numbers, so it makes no strings.
+ * With BLOCKEDITOR_TRACE_FILE, the trace is written into the file in the Chrome trace format,
+ * the spans of the plan build, the evaluation of the blocks and the batches on their threads,
+ * the collection of the results and the update of the window show the timeline of the run.
+ * 
+ * Run > Profile blocks measures the time of the computation of every block. The times and the
+ * counts of the evaluations are summed over the runs (until the profiling is turned off), the
+ * blocks are colored from green (cheap) to red (expensive) and their tooltips show ns/eval.
+ * The clock is read only while profiling, otherwise it costs one check per block.
+ * 
+ * The model is built also without Qt (NO_QT defined, see headless.h). The benchmarks (make bench)
+ * generate the chains, the trees, the random graphs and the mixes of all the block types by the
+ * given seed and time the load, the build, the evaluation and the save of them separately.
+ * make bench-check compares the medians and the counts of the allocations with bench/baseline.txt
+ * and fails, when any of them grows over the threshold (make bench-baseline writes the file).
  * 
  * 
  * \image html classes.png "Class diagram."
@@ -0,0 +1,84 @@
+/**
+ * @file memoryreport.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief memory accounting module
+ *
+ * This module contains the memory report.
+ */
+
+#include <sstream>
+
+#include "memoryreport.h"
+
+void MemoryReport::add(const std::string& name, size_t count, size_t bytes)
+{
+    for(auto& it: mitems)
+    {
+        if(it.name != name) continue;
+        it.count += count;
+        it.bytes += bytes;
+        return;
+    }
+    MemoryItem i;
+    i.name = name;
+    i.count = count;
+    i.bytes = bytes;
+    mitems.push_back(i);
+}
+
+void MemoryReport::addAllocation(size_t bytes)
+{
+    add("allocator overhead", 1, getFootprint(bytes) - bytes);
+}
+
+void MemoryReport::addShared(const std::string& name, size_t bytes)
+{
+    add(name, 1, bytes);
+    add("shared_ptr control blocks", 1, ControlBlock);
+    addAllocation(ControlBlock + bytes);
+}
+
+void MemoryReport::addString(const std::string& s)
+{
+    if(s.capacity() <= ShortString) return;
+    add("strings", 1, s.capacity() + 1);
+    addAllocation(s.capacity() + 1);
+}
+
+void MemoryReport::addVector(const std::string& name, const std::vector<bool>& v)
+{
+    if(v.capacity() == 0) return;
+    add(name, 1, v.capacity() / 8);
+    addAllocation(v.capacity() / 8);
+}
+
+void MemoryReport::addNodes(size_t count, size_t value)
+{
+    if(count == 0) return;
+    add("map nodes", count, count * (TreeNode + value));
+    add("allocator overhead", count, count * (getFootprint(TreeNode + value) - TreeNode - value));
+}
+
+size_t MemoryReport::getTotal() const
+{
+    size_t t = 0;
+    for(auto& it: mitems) t += it.bytes;
+    return t;
+}
+
+std::string MemoryReport::getText() const
+{
+    std::ostringstream os;
+    os << "category,count,bytes\n";
+    for(auto& it: mitems) os << it.name << "," << it.count << "," << it.bytes << "\n";
+    os << "total,," << getTotal() << "\n";
+    return os.str();
+}
+
+size_t MemoryReport::getFootprint(size_t bytes)
+{
+    // header of the chunk, rounded to 16 bytes, 32 bytes at least
+    size_t b = (bytes + sizeof(size_t) + 15) / 16 * 16;
+    return (b < 32) ? 32 : b;
+}
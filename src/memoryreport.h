@@ -0,0 +1,127 @@
+/**
+ * @file memoryreport.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief memory accounting interface
+ *
+ * This module sums the memory used by the objects of the scheme. The objects
+ * add their sizes by the categories (blocks, ports, nodes of the maps, ...),
+ * the containers count the capacity, not the size. Every allocation on the
+ * heap also adds the rounding and the header of the allocator (glibc: 16
+ * bytes alignment, 8 bytes header, 32 bytes at least). The sizes of the
+ * nodes of the maps and of the control blocks of std::shared_ptr follow
+ * libstdc++, they are close with the other libraries.
+ */
+
+#ifndef MEMORYREPORT_H
+#define MEMORYREPORT_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Category of the report.
+ */
+struct MemoryItem {
+    std::string name; /**< Name of the category. */
+    size_t count = 0; /**< Count of the objects. */
+    size_t bytes = 0; /**< Bytes. */
+};
+
+/**
+ * @brief Memory report.
+ */
+class MemoryReport
+{
+    public:
+        /** @brief Bytes of the control block of std::make_shared (without the object). */
+        static constexpr size_t ControlBlock = sizeof(void*) + 2 * sizeof(int);
+        /** @brief Bytes of the node of the red-black tree (without the value). */
+        static constexpr size_t TreeNode = 4 * sizeof(void*);
+        /** @brief Capacity of the string kept in the string itself. */
+        static constexpr size_t ShortString = 15;
+
+        /**
+         * @brief Adds the objects to the category.
+         * @param name      Name of the category.
+         * @param count     Count of the objects.
+         * @param bytes     Bytes of all of them.
+         */
+        void add(const std::string& name, size_t count, size_t bytes);
+        /**
+         * @brief Adds the overhead of the allocator for the allocation.
+         * @param bytes     Requested bytes.
+         */
+        void addAllocation(size_t bytes);
+        /**
+         * @brief Adds the object made by std::make_shared (one allocation).
+         * @param name      Name of the category.
+         * @param bytes     Bytes of the object.
+         */
+        void addShared(const std::string& name, size_t bytes);
+        /**
+         * @brief Adds the characters of the string, if they are on the heap
+         *        (not in the string itself).
+         * @param s         String.
+         */
+        void addString(const std::string& s);
+        /**
+         * @brief Adds the nodes of the map (or the set).
+         * @param count     Count of the nodes.
+         * @param value     Bytes of the value (key and mapped value).
+         */
+        void addNodes(size_t count, size_t value);
+        /**
+         * @brief Adds the buffer of the vector.
+         * @param name      Name of the category.
+         * @param v         Vector.
+         */
+        template <class T>
+        void addVector(const std::string& name, const std::vector<T>& v)
+        {
+            if(v.capacity() == 0) return;
+            add(name, 1, v.capacity() * sizeof(T));
+            addAllocation(v.capacity() * sizeof(T));
+        }
+        /**
+         * @brief Adds the buffer of the vector of bits.
+         * @param name      Name of the category.
+         * @param v         Vector.
+         */
+        void addVector(const std::string& name, const std::vector<bool>& v);
+        /**
+         * @brief Adds the nodes of the map.
+         * @param m         Map.
+         */
+        template <class K, class V>
+        void addMap(const std::map<K,V>& m) { addNodes(m.size(), sizeof(typename std::map<K,V>::value_type)); }
+
+        /**
+         * @brief Total getter.
+         * @returns Bytes of all the categories.
+         */
+        size_t getTotal() const;
+        /**
+         * @brief Categories getter.
+         * @returns Categories in the order, they were added.
+         */
+        const std::vector<MemoryItem>& getItems() const { return mitems; }
+        /**
+         * @brief Report as text (category,count,bytes).
+         * @returns Text.
+         */
+        std::string getText() const;
+
+        /**
+         * @brief Bytes of the heap taken by the allocation.
+         * @param bytes     Requested bytes.
+         * @returns Bytes including the header and the rounding.
+         */
+        static size_t getFootprint(size_t bytes);
+
+    private:
+        std::vector<MemoryItem> mitems; /**< Categories. */
+};
+
+#endif // MEMORYREPORT_H
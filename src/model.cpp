@@ -7,16 +7,17 @@
  * This module contains model implementation.
  */
 
+#include <algorithm>
 #include <iostream>
 
 #include "block.h"
 #include "config.h"
 #include "model.h"
 
-void Model::slotCreateBlock(long type, long& key)
+void Model::slotCreateBlock(long type, int ports, long& key)
 {
     key = GenerateBlockKey();
-    Debug::Model( "Model::slotCreateBlock("+std::to_string(key)+")" );
+    Debug::Model("Model::slotCreateBlock()", key);
 
     std::shared_ptr<IBlock> b;
     BlockType bt = Config::decodeBlockType(type);
@@ -25,8 +26,9 @@ void Model::slotCreateBlock(long type, long& key)
     {
         // two inputs, one output
         case BlockType::TwoIn_OneOut:
-            b = std::make_shared< Block<std::function<double(double,double)>> >(
+            b = std::make_shared< Block<std::function<double(double,double,EvalError&)>> >(
                 key,
+                mStore,
                 Config::getFunc_2I1O(type),
                 Config::getInput(type),
                 Config::getOutput(type),
@@ -36,8 +38,9 @@ void Model::slotCreateBlock(long type, long& key)
 
         // one input, one output
         case BlockType::OneIn_OneOut:
-            b = std::make_shared< Block<std::function<double(double)>> >(
+            b = std::make_shared< Block<std::function<double(double,EvalError&)>> >(
                 key,
+                mStore,
                 Config::getFunc_1I1O(type),
                 Config::getInput(type),
                 Config::getOutput(type),
@@ -45,6 +48,18 @@ void Model::slotCreateBlock(long type, long& key)
             );
             break;
 
+        // N inputs, one output
+        case BlockType::NIn_OneOut:
+            b = std::make_shared< Block<std::function<double(const double*,size_t,EvalError&)>> >(
+                key,
+                mStore,
+                Config::getFunc_NI1O(type),
+                Config::getInput(type, ports),
+                Config::getOutput(type),
+                type
+            );
+            break;
+
         // unknown block
         default:
             throw MyError("Unknown block type", ErrorType::BlockError);
@@ -52,9 +67,14 @@ void Model::slotCreateBlock(long type, long& key)
     mBlocks.insert( std::make_pair(key, b) );
 }
 
+#ifdef NO_QT
+// without Qt, there is no moc to generate the signal
+void Model::sigDeleteWire(long) {}
+#endif
+
 void Model::slotDeleteBlock(long key)
 {
-    Debug::Model( "Model::slotDeleteBlock("+std::to_string(key)+")" );
+    Debug::Model("Model::slotDeleteBlock()", key);
     // get connected wires
     std::map<long,int> wkeys = mBlocks.at(key)->getWireKeys();
 
@@ -80,7 +100,7 @@ void Model::slotCreateWire(PortID startkey, PortID endkey, long& key, bool& succ
         startkey = endkey;
         endkey = tmp;
     }
-    if(startkey.port >= 0 && endkey.port >= 0)
+    if((startkey.port >= 0 && endkey.port >= 0) || (startkey.port < 0 && endkey.port < 0))
     {
         //std::cerr << "Must be output to input!\n";
         success = false;
@@ -88,7 +108,7 @@ void Model::slotCreateWire(PortID startkey, PortID endkey, long& key, bool& succ
     }
 
     key = GenerateWireKey();
-    Debug::Model( "Model::slotCreateWire("+std::to_string(key)+")" );
+    Debug::Model("Model::slotCreateWire()", key);
 
     if(mBlocks.count(startkey.key) == 0 || mBlocks.count(endkey.key) == 0)
     {
@@ -116,7 +136,7 @@ void Model::slotCreateWire(PortID startkey, PortID endkey, long& key, bool& succ
 
 void Model::slotDeleteWire(long key)
 {
-    Debug::Model("Model::slotDeleteWire("+std::to_string(key)+")");
+    Debug::Model("Model::slotDeleteWire()", key);
     if(mWires.count(key) > 0)
         mWires.erase(key);
 }
@@ -124,9 +144,9 @@ void Model::slotDeleteWire(long key)
 void Model::slotCreateInput(Value value, long& key)
 {
     key = GenerateBlockKey();
-    Debug::Model( "Model::slotCreateInput("+std::to_string(key)+")" );
+    Debug::Model("Model::slotCreateInput()", key);
 
-    std::shared_ptr<IBlock> b = std::make_shared<Input>(key,value);
+    std::shared_ptr<IBlock> b = std::make_shared<Input>(key,value,mStore);
 
     mBlocks.insert( std::make_pair(key, b) );
     mInputs.insert( key );
@@ -137,20 +157,90 @@ void Model::slotInputValueChanged(long key, Value value)
     mBlocks.at(key)->setValue(value);
 }
 
-SimulationResults Model::startComputation()
+void Model::slotInputConstantChanged(long key, bool constant)
 {
+    mBlocks.at(key)->setConstant(constant);
+}
+
+SimulationResults Model::startComputation(ComputeProgress* progress)
+{
+    Debug::Span span(Debug::TraceCompute, "Model::startComputation()");
+    if(progress != nullptr) progress->total = mBlocks.size() - mInputs.size();
+    mStore.setProgress(progress);
     // collect results
     SimulationResults::resetMaxLevel();
     SimulationResults sr;
-    for(auto& inkey: mInputs)
+    try
+    {
+        for(auto& inkey: mInputs)
+        {
+            sr.mergeWith(mBlocks.at(inkey)->distributeResult());
+        }
+    }
+    catch(...)
     {
-        sr.mergeWith(mBlocks.at(inkey)->distributeResult());
+        // the blocks computed before the error must not be skipped by the next run
+        mStore.setProgress(nullptr);
+        endComputation();
+        throw;
     }
+    mStore.setProgress(nullptr);
 
     endComputation();
     return sr;
 }
 
+Plan Model::buildPlan(const std::set<long>& outputs)
+{
+    Debug::Model("Model::buildPlan()");
+    Debug::Span span(Debug::TraceCompute, "Model::buildPlan()");
+    Plan p = collectPlan();
+    p.optimize(outputs);
+    return p;
+}
+
+Plan Model::collectPlan()
+{
+    Plan p;
+    for(auto& inkey: mInputs)
+    {
+        std::shared_ptr<IBlock> b = mBlocks.at(inkey);
+        p.addInput(inkey, b->getSlot(), b->getValue(), b->isConstant());
+    }
+
+    // levels give the topological order
+    std::vector<std::pair<int,long>> order;
+    for(auto& it: mBlocks)
+    {
+        if(!it.second->isInput()) order.push_back( std::make_pair(it.second->getLevel(), it.first) );
+    }
+    std::sort(order.begin(), order.end());
+
+    for(auto& it: order)
+    {
+        std::shared_ptr<IBlock> b = mBlocks.at(it.second);
+        // an unconnected input would drop the block and everything after it
+        if(!p.addBlock(it.second, b->getType(), b->getInputSlots(), b->getSlot(), it.first))
+            throw MyError("Block "+std::to_string(it.second)+" has an unconnected input", ErrorType::BlockError);
+    }
+    return p;
+}
+
+SchemeAnalysis Model::analyze()
+{
+    Debug::Model("Model::analyze()");
+    SchemeAnalysis a = Analysis::analyze(collectPlan(), getProfile());
+    // wires between the successive blocks of the path
+    std::map<long,long> next;
+    for(size_t i = 0; i + 1 < a.path.size(); i++) next[a.path[i]] = a.path[i + 1];
+    for(auto& it: mWires)
+    {
+        auto n = next.find(it.second->getSource());
+        if(n != next.end() && n->second == it.second->getTarget()) a.wires.push_back(it.first);
+    }
+    return a;
+}
+
 void Model::endComputation()
 {
     for(auto& it: mBlocks)
@@ -165,20 +255,57 @@ void Model::slotReset()
     mWires.clear();
     mBlocks.clear();
     mInputs.clear();
+    mStore.clear();
     mblockkey = 0;
     mwirekey = 0;
 }
 
+std::map<long,BlockCost> Model::getProfile() const
+{
+    std::map<long,BlockCost> r;
+    for(auto& it: mBlocks)
+    {
+        if(!it.second->isInput()) r.insert( std::make_pair(it.first, it.second->getCost()) );
+    }
+    return r;
+}
+
+void Model::resetProfile()
+{
+    for(auto& it: mBlocks) it.second->resetCost();
+}
+
 ModelState Model::getState()
 {
     ModelState s;
     for(auto& it: mBlocks)
     {
         s.blocks.insert( std::make_pair(it.first, it.second->getType()) );
+        if(it.second->isConstant()) s.constants.insert(it.first);
+        if(it.second->getType() >= 0 && Config::decodeBlockType(it.second->getType()) == BlockType::NIn_OneOut)
+            s.ports.insert( std::make_pair(it.first, it.second->getInputCount()) );
     }
     return s;
 }
 
+std::map<long,long> Model::getWireSources() const
+{
+    std::map<long,long> m;
+    for(auto& it: mWires) { m[it.first] = it.second->getSource(); }
+    return m;
+}
+
+void Model::accountMemory(MemoryReport& r) const
+{
+    r.add("Model", 1, sizeof(*this));
+    r.addMap(mBlocks);
+    for(auto& it: mBlocks) { it.second->accountMemory(r); }
+    r.addNodes(mInputs.size(), sizeof(long));
+    r.addMap(mWires);
+    for(size_t i = 0; i < mWires.size(); i++) { r.addShared("Wire", sizeof(Wire)); }
+    mStore.accountMemory(r);
+}
+
 void Model::setState(ModelState s)
 {
     mblockkey = 0;
@@ -193,13 +320,15 @@ void Model::setState(ModelState s)
         if(it.second == -1)
         {
             slotCreateInput(Value(), key);
+            slotInputConstantChanged(key, s.constants.count(it.first) > 0);
         }
         // blcok
         else
         {
-            slotCreateBlock(it.second, key);
+            int ports = (s.ports.count(it.first) > 0) ? s.ports.at(it.first) : 0;
+            slotCreateBlock(it.second, ports, key);
         }
-        Debug::File("Save "+std::to_string(it.second)+" as "+std::to_string(it.first));
+        Debug::File("Save (type, id)", it.second, it.first);
 
     }
     // wires
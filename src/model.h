@@ -17,11 +17,17 @@
 #include <set>
 #include <string>
 
-#include <QObject>
-
+#include "analysis.h"
 #include "config.h"
 #include "defs.h"
+#include "headless.h"
 #include "iblock.h"
+#include "memoryreport.h"
+#include "native.h"
+#include "plan.h"
+#include "profile.h"
+#include "program.h"
+#include "valuestore.h"
 #include "wire.h"
 
 /**
@@ -29,6 +35,8 @@
  */
 struct ModelState {
     std::map<long,long> blocks; /**< Block state <id,type>. */
+    std::map<long,int> ports; /**< Input count of blocks with N inputs <id,count>. */
+    std::set<long> constants; /**< Inputs marked constant. */
     // wires
 };
 
@@ -46,15 +54,80 @@ class Model: public QObject
         ~Model() { slotReset(); }
 
         /**
-         * @brief   Computes the results.
+         * @brief   Computes the results. It may run in another thread, while
+         *          the scheme is not edited.
+         * @param   progress    Progress, the blocks report to (may be nullptr).
+         *                      Throws MyError with ErrorType::Cancelled, when cancelled.
          * @returns Results of connected blocks.
          */
-        SimulationResults startComputation();
+        SimulationResults startComputation(ComputeProgress* progress = nullptr);
+        /**
+         * @brief Builds the execution plan of the scheme. Blocks, that cannot
+         *        be evaluated (unconnected input), are left out. Constant
+         *        blocks are folded and blocks, that do not lead to the outputs,
+         *        are dropped (see Plan::optimize).
+         * @param outputs   Blocks selected for output (all if empty).
+         * @returns The plan.
+         */
+        Plan buildPlan(const std::set<long>& outputs = std::set<long>());
+        /**
+         * @brief Compiles the scheme into the bytecode (see buildPlan).
+         * @param outputs   Blocks selected for output (all if empty).
+         * @returns The program.
+         */
+        Program compileProgram(const std::set<long>& outputs = std::set<long>()) { return Program::compile(buildPlan(outputs)); }
+        /**
+         * @brief Compiles the scheme into the native code in the background
+         *        (see NativeEngine). The engine interprets the bytecode, until
+         *        the native code is ready.
+         * @param outputs   Blocks selected for output (all if empty).
+         * @returns The engine.
+         */
+        std::shared_ptr<NativeEngine> compileNative(const std::set<long>& outputs = std::set<long>())
+        {
+            return std::make_shared<NativeEngine>(compileProgram(outputs));
+        }
         /**
          * @brief Gets the state (for saving).
          * @returns The state to save.
          */
         ModelState getState();
+        /**
+         * @brief Sources of the wires getter.
+         * @returns IDs of the wires mapped to the IDs of the blocks, they read.
+         */
+        std::map<long,long> getWireSources() const;
+        /**
+         * @brief Turns the profiling of the blocks on or off (all the models).
+         * @param on        Profiling is on, if true.
+         */
+        void setProfiling(bool on) { Profile::setEnabled(on); }
+        /**
+         * @brief Profiling getter.
+         * @returns True, if the blocks are profiled.
+         */
+        bool isProfiling() const { return Profile::isEnabled(); }
+        /**
+         * @brief Costs of the blocks getter, accumulated over the runs since the reset.
+         * @returns Costs by the IDs of the blocks (not inputs).
+         */
+        std::map<long,BlockCost> getProfile() const;
+        /**
+         * @brief Forgets the costs of the blocks.
+         */
+        void resetProfile();
+        /**
+         * @brief Analyses the critical path and the parallelism of the scheme
+         *        (see Analysis::analyze), with the costs of the profiling.
+         * @returns Analysis.
+         */
+        SchemeAnalysis analyze();
+        /**
+         * @brief Adds the memory of the model (blocks, ports, wires and the
+         *        containers) to the report.
+         * @param r         Report.
+         */
+        void accountMemory(MemoryReport& r) const;
         /**
          * @brief Sets the state (loading the file).
          * @param state     State to set.
@@ -74,9 +147,10 @@ class Model: public QObject
         /**
          * @brief Invocated, when block is created (in GUI).
          * @param type      Type, first octet includes type.
+         * @param ports     Count of inputs (only for blocks with N inputs).
          * @param key       Reference to return generated key.
          */
-        void slotCreateBlock(long type, long& key);
+        void slotCreateBlock(long type, int ports, long& key);
         /**
          * @brief Invocated, when block is deleted (in GUI).
          * @param key       Key of deleted block.
@@ -106,6 +180,12 @@ class Model: public QObject
          * @param value     New value.
          */
         void slotInputValueChanged(long key, Value);
+        /**
+         * @brief Invocated, when input is marked constant or variable (in GUI).
+         * @param key       Key of input.
+         * @param constant  True, if constant.
+         */
+        void slotInputConstantChanged(long key, bool constant);
         /**
          * @brief Resets the model.
          */
@@ -119,6 +199,7 @@ class Model: public QObject
         void sigDeleteWire(long key);
 
     private:
+        ValueStore mStore; /**< Values of the blocks. */
         std::map<long, std::shared_ptr<IBlock>> mBlocks; /**< Map of blocks. */
         std::set<long> mInputs; /**< Input blocks set. */
         std::map<long, std::shared_ptr<Wire>> mWires;    /**< Map of wires. */
@@ -135,6 +216,12 @@ class Model: public QObject
          * @returns         The generated key.
          */
         long GenerateWireKey() { return mwirekey++; }
+        /**
+         * @brief Collects the blocks into the plan (not optimized). Throws, if some block
+         *        has an unconnected input.
+         * @returns The plan.
+         */
+        Plan collectPlan();
 
 };
 
@@ -0,0 +1,178 @@
+/**
+ * @file native.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief native compilation module
+ *
+ * This module contains the native compilation implementation.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#if defined _WIN32 || defined __CYGWIN__
+    #define NATIVE_DISABLED
+#else
+    #include <dlfcn.h>
+    #include <unistd.h>
+#endif
+
+#include "codegen.h"
+#include "debug.h"
+#include "native.h"
+
+namespace {
+    /** @brief Name of the exported function. */
+    const char* EvalSymbol = "blockeditor_eval";
+    /** @brief Count of the compilations started by the process. */
+    std::atomic<unsigned long> Builds(0);
+
+    /**
+     * @brief Hashes the string (FNV-1a, 64 bits).
+     * @param s         String.
+     * @returns Hash in hexadecimal.
+     */
+    std::string hash(const std::string& s)
+    {
+        unsigned long long h = 14695981039346656037ull;
+        for(auto& c: s)
+        {
+            h ^= (unsigned char)c;
+            h *= 1099511628211ull;
+        }
+        std::ostringstream os;
+        os << std::hex << h;
+        return os.str();
+    }
+}
+
+NativeEngine::NativeEngine(const Program& p, bool background):
+    mprogram(p), mfunc(nullptr)
+{
+    // the namespace is fixed, so the source depends only on the scheme
+    msource = CodeGen::generateCpp(mprogram, "scheme");
+    msource += "\nextern \"C\" void " + std::string(EvalSymbol)
+             + "(const double* i, double* o, unsigned char* e) { scheme::eval(i, o, e); }\n";
+    mkey = hash(getCompiler() + "\n" + msource);
+
+    if(background) mthread = std::thread(&NativeEngine::build, this);
+    else build();
+}
+
+NativeEngine::~NativeEngine()
+{
+    if(mthread.joinable()) mthread.join();
+#ifndef NATIVE_DISABLED
+    if(mhandle != nullptr) dlclose(mhandle);
+#endif
+}
+
+bool NativeEngine::wait()
+{
+    if(mthread.joinable()) mthread.join();
+    return isNative();
+}
+
+void NativeEngine::run(const double* inputs, double* outputs, EvalError* errors)
+{
+    EvalFunc f = mfunc.load();
+    if(f != nullptr)
+    {
+        f(inputs, outputs, reinterpret_cast<unsigned char*>(errors));
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mmutex);
+    mprogram.run(inputs, outputs, errors);
+}
+
+std::string NativeEngine::getCacheDir()
+{
+    const char* dir = std::getenv("BLOCKEDITOR_CACHE");
+    if(dir != nullptr && *dir != '\0') return dir;
+    const char* home = std::getenv("HOME");
+    if(home != nullptr && *home != '\0') return std::string(home) + PathSep + ".cache" + PathSep + "blockeditor";
+    std::error_code ec;
+    std::filesystem::path tmp = std::filesystem::temp_directory_path(ec);
+    if(ec) return "";
+    return (tmp / "blockeditor").string();
+}
+
+std::string NativeEngine::getCompiler()
+{
+    const char* cxx = std::getenv("CXX");
+    return (cxx != nullptr && *cxx != '\0') ? cxx : "c++";
+}
+
+void NativeEngine::build()
+{
+    Debug::Span span(Debug::TraceCompute, "NativeEngine::build()");
+#ifdef NATIVE_DISABLED
+    Debug::Compute("NativeEngine::build(): not supported, interpreting");
+#else
+    // runs on the thread, a failure must only leave the interpreter
+    try
+    {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        fs::path dir = getCacheDir();
+        if(dir.empty())
+        {
+            Debug::Compute("NativeEngine::build(): no cache directory, interpreting");
+            return;
+        }
+        fs::create_directories(dir, ec);
+        fs::path so = dir / (mkey + ".so");
+
+        bool cached = fs::exists(so, ec);
+        if(ec)
+        {
+            Debug::Compute("NativeEngine::build(): cache not readable, interpreting");
+            return;
+        }
+        if(!cached)
+        {
+            Debug::Compute("NativeEngine::build(): compiling");
+            // unique names, other processes and other engines may compile the same scheme
+            std::string tmp = mkey + "." + std::to_string(getpid()) + "." + std::to_string(Builds++);
+            fs::path src = dir / (tmp + ".cpp");
+            fs::path obj = dir / (tmp + ".so");
+            fs::path log = dir / (tmp + ".log");
+            std::ofstream(src) << msource;
+
+            std::string cmd = getCompiler() + " -std=c++17 -O2 -shared -fPIC -o \"" + obj.string()
+                            + "\" \"" + src.string() + "\" 2> \"" + log.string() + "\"";
+            int ret = std::system(cmd.c_str());
+            fs::remove(src, ec);
+            if(ret != 0)
+            {
+                Debug::Compute("NativeEngine::build(): compilation failed, interpreting");
+                fs::remove(obj, ec);
+                // the messages of the compiler are kept
+                fs::rename(log, dir / (mkey + ".log"), ec);
+                return;
+            }
+            fs::remove(log, ec);
+            fs::rename(obj, so, ec);
+            if(ec) { fs::remove(obj, ec); return; }
+        }
+
+        mhandle = dlopen(so.string().c_str(), RTLD_NOW | RTLD_LOCAL);
+        if(mhandle == nullptr)
+        {
+            Debug::Compute("NativeEngine::build(): cannot load, interpreting");
+            return;
+        }
+        EvalFunc f = reinterpret_cast<EvalFunc>(dlsym(mhandle, EvalSymbol));
+        if(f == nullptr) return;
+        Debug::Compute("NativeEngine::build(): native");
+        mfunc.store(f);
+    }
+    catch(std::exception&)
+    {
+        Debug::Compute("NativeEngine::build(): failed, interpreting");
+    }
+#endif
+}
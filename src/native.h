@@ -0,0 +1,110 @@
+/**
+ * @file native.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief native compilation interface
+ *
+ * This module compiles the scheme into the native code. The generated
+ * C++ source (see codegen.h) is compiled by the system compiler into
+ * a shared object, which is loaded at runtime. The shared objects are
+ * cached on the disk by the hash of the source, so the same scheme is
+ * compiled only once. The compilation runs in the background, until it
+ * is done, the bytecode interpreter is used.
+ */
+
+#ifndef NATIVE_H
+#define NATIVE_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "program.h"
+
+/**
+ * @brief Evaluator switching from the bytecode to the native code.
+ */
+class NativeEngine
+{
+    public:
+        /** @brief Type of the native function. */
+        typedef void (*EvalFunc)(const double*, double*, unsigned char*);
+
+        /**
+         * @brief NativeEngine constructor. Starts the compilation.
+         * @param p             Compiled program.
+         * @param background    Compiles in the background thread, if true.
+         */
+        NativeEngine(const Program& p, bool background = true);
+        /**
+         * @brief NativeEngine destructor. Waits for the compilation and
+         *        unloads the shared object.
+         */
+        ~NativeEngine();
+        NativeEngine(const NativeEngine&) = delete;
+        NativeEngine& operator=(const NativeEngine&) = delete;
+
+        /**
+         * @brief Evaluates the scheme (see Program::run). Uses the native
+         *        function once it is ready, the interpreter before.
+         * @param inputs    Values of the inputs, in the order of getProgram().getInputs().
+         * @param outputs   Values of the outputs, in the order of getProgram().getOutputs().
+         * @param errors    Errors of the outputs (may be nullptr).
+         */
+        void run(const double* inputs, double* outputs, EvalError* errors = nullptr);
+        /**
+         * @brief Indicates, weather the native function is used.
+         * @returns True, if native.
+         */
+        bool isNative() const { return mfunc.load() != nullptr; }
+        /**
+         * @brief Native function getter. The function keeps no state, so it may
+         *        be called from many threads at once (unlike run before it is ready).
+         * @returns Native function (nullptr until ready).
+         */
+        EvalFunc getFunction() const { return mfunc.load(); }
+        /**
+         * @brief Waits for the compilation.
+         * @returns True, if the native function is used.
+         */
+        bool wait();
+        /**
+         * @brief Program getter.
+         * @returns Program.
+         */
+        const Program& getProgram() const { return mprogram; }
+        /**
+         * @brief Key of the cache getter.
+         * @returns Hash of the source and the compiler.
+         */
+        const std::string& getKey() const { return mkey; }
+
+        /**
+         * @brief Directory of the cache. It is $BLOCKEDITOR_CACHE, or
+         *        ~/.cache/blockeditor, or blockeditor in the temporary directory.
+         * @returns Path to the directory, empty if there is no temporary directory.
+         */
+        static std::string getCacheDir();
+        /**
+         * @brief Compiler. It is $CXX, or c++.
+         * @returns Compiler command.
+         */
+        static std::string getCompiler();
+
+    private:
+        Program mprogram; /**< Program (the interpreter). */
+        std::mutex mmutex; /**< Guards the interpreter (it has one register file). */
+        std::atomic<EvalFunc> mfunc; /**< Native function (nullptr until ready). */
+        void* mhandle = nullptr; /**< Handle of the shared object. */
+        std::thread mthread; /**< Compilation thread. */
+        std::string msource; /**< Generated source. */
+        std::string mkey; /**< Key in the cache. */
+
+        /**
+         * @brief Compiles the source (or finds it in the cache) and loads it.
+         */
+        void build();
+};
+
+#endif // NATIVE_H
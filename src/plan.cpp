@@ -0,0 +1,417 @@
+/**
+ * @file plan.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief execution plan module
+ *
+ * This module contains the execution plan implementation.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "debug.h"
+#include "plan.h"
+
+size_t BatchResults::getErrorRows() const
+{
+    size_t n = 0;
+    for(auto& it: mrowmask) { if(it != 0) n++; }
+    return n;
+}
+
+long Plan::allocate(long id, long slot, int type)
+{
+    long s = long(mslotcount++);
+    mslots[id] = s;
+    mmodelslots[slot] = s;
+    mtypes.push_back(type);
+    return s;
+}
+
+void Plan::addInput(long id, long slot, const Value& v, bool constant)
+{
+    Debug::Compute("Plan::addInput()", id);
+    long s = allocate(id, slot, Config::getTypeId(v.type));
+    minputs.push_back(id);
+    minslots.push_back(s);
+    mdefaults.push_back(v.value);
+    mconstinputs.push_back(constant);
+}
+
+bool Plan::addBlock(long id, long type, const std::vector<long>& in, long slot, int level)
+{
+    PlanNode n;
+    n.id = id;
+    n.type = type;
+    n.kind = Config::decodeBlockType(type);
+    n.level = level;
+
+    // inputs must be produced already
+    int t = -1;
+    for(auto& it: in)
+    {
+        if(it < 0 || mmodelslots.count(it) == 0) return false;
+        long s = mmodelslots.at(it);
+        if(t < 0) t = mtypes[s];
+        else if(t != mtypes[s]) throw MyError("Incompatible types", ErrorType::TypeError);
+        n.in.push_back(s);
+    }
+    Debug::Compute("Plan::addBlock()", id);
+
+    switch(n.kind)
+    {
+        case BlockType::OneIn_OneOut: n.f1 = Config::getFunc_1I1O(type); break;
+        case BlockType::TwoIn_OneOut: n.f2 = Config::getFunc_2I1O(type); break;
+        case BlockType::NIn_OneOut: n.fn = Config::getFunc_NI1O(type); break;
+    }
+
+    n.out = allocate(id, slot, t);
+    mnodes.push_back(n);
+    return true;
+}
+
+void Plan::optimize(const std::set<long>& outputs)
+{
+    Debug::Span span(Debug::TraceCompute, "Plan::optimize()");
+    // evaluate everything once, the constants are taken from here
+    BatchResults once;
+    evaluate(mdefaults, 1, once);
+
+    // constant slots
+    std::vector<bool> constant(mslotcount, false);
+    for(size_t i = 0; i < minslots.size(); i++) { constant[minslots[i]] = mconstinputs[i]; }
+    for(auto& n: mnodes)
+    {
+        bool c = true;
+        for(auto& it: n.in) { c = c && constant[it]; }
+        constant[n.out] = c;
+    }
+    simplify(constant, once);
+    share(constant);
+
+    // live slots: outputs and everything they depend on
+    std::vector<bool> live(mslotcount, outputs.empty());
+    for(auto& it: outputs) { if(mslots.count(it) > 0) live[mslots.at(it)] = true; }
+    for(auto n = mnodes.rbegin(); n != mnodes.rend(); n++)
+    {
+        if(!live[n->out]) continue;
+        for(auto& it: n->in) { live[it] = true; }
+    }
+
+    // slots needed in the hot loop: live and not constant, and whatever they read
+    std::vector<bool> needed(mslotcount, false);
+    std::vector<PlanNode> nodes;
+    for(auto& n: mnodes)
+    {
+        if(!live[n.out] || constant[n.out]) continue;
+        needed[n.out] = true;
+        for(auto& it: n.in) { needed[it] = true; }
+        nodes.push_back(n);
+    }
+    for(auto& it: outputs) { if(mslots.count(it) > 0) needed[mslots.at(it)] = true; }
+    if(outputs.empty()) { needed.assign(mslotcount, true); }
+    else
+    {
+        std::vector<bool> out(mslotcount, false);
+        for(auto& it: outputs) { if(mslots.count(it) > 0) out[mslots.at(it)] = true; }
+        fuse(nodes, needed, out);
+    }
+
+    // renumber the slots: variable inputs, constants, blocks
+    std::vector<long> remap(mslotcount, -1);
+    long next = 0;
+    std::vector<long> inputs, inslots;
+    std::vector<double> defaults;
+    std::vector<bool> constinputs;
+    for(size_t i = 0; i < minslots.size(); i++)
+    {
+        if(mconstinputs[i]) continue;
+        remap[minslots[i]] = next;
+        inputs.push_back(minputs[i]);
+        inslots.push_back(next++);
+        defaults.push_back(mdefaults[i]);
+        constinputs.push_back(false);
+    }
+    std::vector<Constant> constants;
+    for(size_t s = 0; s < mslotcount; s++)
+    {
+        if(!constant[s] || !needed[s]) continue;
+        remap[s] = next;
+        constants.push_back({next++, once.mvalues[s], EvalError(once.merrors[s])});
+    }
+    for(auto& n: nodes)
+    {
+        remap[n.out] = next;
+        n.out = next++;
+        for(auto& it: n.in) { it = remap[it]; }
+    }
+
+    // IDs of the blocks, that are left
+    std::map<long,long> slots;
+    std::vector<int> types(next, -1);
+    for(auto& it: mslots)
+    {
+        if(remap[it.second] < 0) continue;
+        slots.insert( std::make_pair(it.first, remap[it.second]) );
+        types[remap[it.second]] = mtypes[it.second];
+    }
+    std::map<long,long> modelslots;
+    for(auto& it: mmodelslots)
+    {
+        if(remap[it.second] >= 0) modelslots.insert( std::make_pair(it.first, remap[it.second]) );
+    }
+
+    Debug::Compute("Plan::optimize(blocks, optimized, constants)", mnodes.size(), nodes.size(), constants.size());
+    minputs = inputs;
+    minslots = inslots;
+    mdefaults = defaults;
+    mconstinputs = constinputs;
+    mconstants = constants;
+    mnodes = nodes;
+    mslots = slots;
+    mmodelslots = modelslots;
+    mtypes = types;
+    mslotcount = size_t(next);
+}
+
+void Plan::simplify(const std::vector<bool>& constant, const BatchResults& once)
+{
+    auto& names = Config::getBlockNames();
+    const long tneg = names.at("neg"), tsquared = names.at("squared"), tsqrt = names.at("sqrt");
+    const long tex = names.at("ex"), tln = names.at("ln");
+    const long tadd = names.at("adder"), tsub = names.at("subtractor");
+    const long tmul = names.at("multiplier"), tdiv = names.at("divider");
+
+    // slot holds the constant of the value (without error)
+    auto is = [&](long slot, double value) {
+        return constant[slot] && once.merrors[slot] == EvalError::EvalOk && once.mvalues[slot] == value;
+    };
+
+    std::vector<long> replace(mslotcount);
+    for(size_t i = 0; i < mslotcount; i++) { replace[i] = long(i); }
+    std::map<long,size_t> producer; // slot -> index of node in nodes
+    std::vector<PlanNode> nodes;
+    for(auto& it: mnodes)
+    {
+        PlanNode n = it;
+        for(auto& in: n.in) { in = replace[in]; }
+        if(constant[n.out]) { producer[n.out] = nodes.size(); nodes.push_back(n); continue; }
+
+        long alias = -1;
+        const PlanNode* inner = nullptr;
+        if(n.kind == BlockType::OneIn_OneOut && producer.count(n.in[0]) > 0)
+            inner = &nodes[producer.at(n.in[0])];
+
+        if(inner != nullptr && n.type == tneg && inner->type == tneg)
+        {
+            alias = inner->in[0];
+        }
+        else if(inner != nullptr && ((n.type == tsqrt && inner->type == tsquared) || (n.type == tln && inner->type == tex)))
+        {
+            // the identity holds well inside the range of doubles, out of it the original is computed
+            auto fi = inner->f1, fo = n.f1;
+            double lo = (n.type == tsqrt) ? SqrtOfSquaredMin : 0;
+            double hi = (n.type == tsqrt) ? SqrtOfSquaredMax : LogOfExpMax;
+            bool ab = (n.type == tsqrt);
+            n.f1 = [fi,fo,lo,hi,ab](double x, EvalError& e) {
+                double a = std::fabs(x);
+                if(a >= lo && a < hi) return ab ? a : x;
+                return fo(fi(x,e),e);
+            };
+            n.type = (n.type == tsqrt) ? PlanNodeType::SqrtOfSquared : PlanNodeType::LogOfExp;
+            mrewrites[n.id] = {n.id, inner->id};
+            n.in[0] = inner->in[0];
+        }
+        else if(n.type == tmul && is(n.in[1],1)) alias = n.in[0];
+        else if(n.type == tmul && is(n.in[0],1)) alias = n.in[1];
+        else if(n.type == tadd && is(n.in[1],0)) alias = n.in[0];
+        else if(n.type == tadd && is(n.in[0],0)) alias = n.in[1];
+        else if((n.type == tsub || n.type == tdiv) && is(n.in[1], (n.type == tsub) ? 0 : 1)) alias = n.in[0];
+
+        if(alias >= 0)
+        {
+            Debug::Compute("Plan::simplify(): aliased", n.id);
+            std::vector<long> orig = {n.id};
+            if(inner != nullptr) orig.push_back(inner->id);
+            mrewrites[n.id] = orig;
+            replace[n.out] = alias;
+            mslots[n.id] = alias;
+            continue;
+        }
+        producer[n.out] = nodes.size();
+        nodes.push_back(n);
+    }
+    for(auto& it: mmodelslots) { it.second = replace[it.second]; }
+    mnodes = nodes;
+}
+
+void Plan::share(const std::vector<bool>& constant)
+{
+    auto& names = Config::getBlockNames();
+    // inputs may be swapped
+    const std::set<long> commutative = { names.at("adder"), names.at("multiplier"),
+        names.at("sum"), names.at("product"), names.at("min"), names.at("max") };
+
+    std::vector<long> replace(mslotcount);
+    for(size_t i = 0; i < mslotcount; i++) { replace[i] = long(i); }
+    std::map<std::pair<long,std::vector<long>>,long> seen; // (type, inputs) -> slot
+    std::vector<PlanNode> nodes;
+    for(auto& it: mnodes)
+    {
+        PlanNode n = it;
+        for(auto& in: n.in) { in = replace[in]; }
+        if(constant[n.out]) { nodes.push_back(n); continue; }
+
+        std::vector<long> key = n.in;
+        if(commutative.count(n.type) > 0) std::sort(key.begin(), key.end());
+        auto found = seen.find( std::make_pair(n.type, key) );
+        if(found != seen.end())
+        {
+            Debug::Compute("Plan::share(): shared", n.id);
+            replace[n.out] = found->second;
+            continue;
+        }
+        seen.insert( std::make_pair(std::make_pair(n.type, key), n.out) );
+        nodes.push_back(n);
+    }
+    // also the blocks aliased by simplify() to the slot of a duplicate
+    for(auto& it: mslots) { it.second = replace[it.second]; }
+    for(auto& it: mmodelslots) { it.second = replace[it.second]; }
+    mnodes = nodes;
+}
+
+void Plan::fuse(std::vector<PlanNode>& nodes, std::vector<bool>& needed, const std::vector<bool>& outputs)
+{
+    // count of the readers of every slot
+    std::map<long,int> readers;
+    for(auto& n: nodes) { for(auto& it: n.in) { readers[it]++; } }
+
+    std::map<long,size_t> producer; // slot -> index of node in fused
+    std::vector<PlanNode> fused;
+    for(auto& n: nodes)
+    {
+        auto p = (n.kind == BlockType::OneIn_OneOut) ? producer.find(n.in[0]) : producer.end();
+        if(p == producer.end() || fused[p->second].kind != BlockType::OneIn_OneOut
+           || readers.at(n.in[0]) != 1 || outputs[n.in[0]])
+        {
+            producer[n.out] = fused.size();
+            fused.push_back(n);
+            continue;
+        }
+
+        // append to the chain of the producer
+        size_t idx = p->second;
+        PlanNode& f = fused[idx];
+        if(f.type != PlanNodeType::Fused)
+        {
+            PlanNode first = f;
+            f.chain.push_back(first);
+            f.type = PlanNodeType::Fused;
+        }
+        f.chain.push_back(n);
+        needed[f.out] = false;
+        producer.erase(f.out);
+        f.id = n.id;
+        f.out = n.out;
+        f.level = n.level;
+        producer[f.out] = idx;
+
+        std::vector<std::function<double(double,EvalError&)>> links;
+        for(auto& it: f.chain) { links.push_back(it.f1); }
+        f.f1 = [links](double x, EvalError& e) {
+            for(size_t i = 0; i < links.size(); i++)
+            {
+                x = links[i](x,e);
+                // error inside the chain ends it, the chain keeps the error of the failed link
+                if(e != EvalError::EvalOk && i+1 < links.size())
+                    return std::numeric_limits<double>::quiet_NaN();
+            }
+            return x;
+        };
+        Debug::Compute("Plan::fuse(): fused (id, blocks)", n.id, f.chain.size());
+    }
+    nodes = fused;
+}
+
+void Plan::evaluate(const std::vector<double>& inputs, size_t rows, BatchResults& r) const
+{
+    if(inputs.size() != minputs.size()*rows)
+        throw MyError("Wrong count of input values", ErrorType::BlockError);
+
+    // (re)initialize the results, buffers keep their capacity
+    r.mrows = rows;
+    r.mslots = mslots;
+    r.mvalues.resize(mslotcount*rows);
+    r.merrors.assign(mslotcount*rows, EvalError::EvalOk);
+    r.mrowmask.assign(rows, 0);
+    r.mslotmask.assign(mslotcount, 0);
+
+    double* v = r.mvalues.data();
+    unsigned char* e = r.merrors.data();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    // inputs
+    for(size_t i = 0; i < minslots.size(); i++)
+    {
+        std::copy(inputs.begin() + i*rows, inputs.begin() + (i+1)*rows, v + minslots[i]*rows);
+    }
+    // folded constants
+    for(auto& c: mconstants)
+    {
+        std::fill(v + c.slot*rows, v + (c.slot+1)*rows, c.value);
+        if(c.error == EvalError::EvalOk) continue;
+        std::fill(e + c.slot*rows, e + (c.slot+1)*rows, c.error);
+        r.mslotmask[c.slot] |= 1u << c.error;
+        for(auto& it: r.mrowmask) { it |= 1u << c.error; }
+    }
+
+    // blocks, column by column
+    std::vector<double> args;
+    for(auto& n: mnodes)
+    {
+        Debug::Span span(Debug::TraceCompute, "Plan::evaluate(block, level)", n.id, n.level);
+        double* o = v + n.out*rows;
+        unsigned char* eo = e + n.out*rows;
+
+        for(size_t row = 0; row < rows; row++)
+        {
+            // poisoned by the erroneous input
+            bool poisoned = false;
+            for(auto& it: n.in) { if(e[it*rows + row] != EvalError::EvalOk) { poisoned = true; break; } }
+            if(poisoned)
+            {
+                o[row] = nan;
+                eo[row] = EvalError::Poisoned;
+                continue;
+            }
+
+            EvalError err = EvalError::EvalOk;
+            switch(n.kind)
+            {
+                case BlockType::OneIn_OneOut:
+                    o[row] = n.f1(v[n.in[0]*rows + row], err);
+                    break;
+                case BlockType::TwoIn_OneOut:
+                    o[row] = n.f2(v[n.in[0]*rows + row], v[n.in[1]*rows + row], err);
+                    break;
+                case BlockType::NIn_OneOut:
+                    args.resize(n.in.size());
+                    for(size_t i = 0; i < n.in.size(); i++) { args[i] = v[n.in[i]*rows + row]; }
+                    o[row] = n.fn(args.data(), args.size(), err);
+                    break;
+            }
+            eo[row] = err;
+        }
+
+        // error masks
+        unsigned& mask = r.mslotmask[n.out];
+        for(size_t row = 0; row < rows; row++)
+        {
+            if(eo[row] == EvalError::EvalOk) continue;
+            mask |= 1u << eo[row];
+            r.mrowmask[row] |= 1u << eo[row];
+        }
+    }
+}
@@ -0,0 +1,282 @@
+/**
+ * @file plan.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief execution plan interface
+ *
+ * This module contains the execution plan. It is a flat list of the
+ * blocks of the scheme in the topological order, that evaluates many
+ * rows of inputs at once. The errors are not thrown, they are carried
+ * as data along with the values.
+ */
+
+#ifndef PLAN_H
+#define PLAN_H
+
+#include <functional>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "config.h"
+#include "defs.h"
+
+/**
+ * @brief Types of the nodes made by the rewrites of the plan (these are
+ *        not among the blocks in Config).
+ */
+enum PlanNodeType : long
+{
+    SqrtOfSquared = -2, /**< sqrt(squared(x)), that is abs(x). */
+    LogOfExp = -3,      /**< ln(ex(x)), that is x. */
+    Fused = -4          /**< Chain of the blocks with one input (see PlanNode::chain). */
+};
+
+/** @brief Range of |x|, where sqrt(squared(x)) is computed as abs(x). */
+constexpr double SqrtOfSquaredMin = 1e-150, SqrtOfSquaredMax = 1e150;
+/** @brief Bound of |x|, below which ln(ex(x)) is computed as x. */
+constexpr double LogOfExpMax = 700;
+
+/**
+ * @brief Node of the plan (single block).
+ */
+struct PlanNode
+{
+    long id; /**< ID of the block. */
+    long type; /**< Type of the block (or PlanNodeType). */
+    BlockType kind; /**< Port layout of the block. */
+    std::vector<long> in; /**< Slots of the inputs. */
+    long out; /**< Slot of the output. */
+    int level; /**< Level of the block. */
+
+    std::function<double(double,EvalError&)> f1; /**< Function (1 input). */
+    std::function<double(double,double,EvalError&)> f2; /**< Function (2 inputs). */
+    std::function<double(const double*,size_t,EvalError&)> fn; /**< Reduction (N inputs). */
+
+    std::vector<PlanNode> chain; /**< Fused blocks in the order of evaluation (Fused only). */
+};
+
+/**
+ * @brief Results of the batch evaluation. Values and errors of every row
+ *        and the error masks (bit 1<<EvalError) of rows and blocks.
+ */
+class BatchResults
+{
+    public:
+        /**
+         * @brief Row count getter.
+         * @returns Count of the evaluated rows.
+         */
+        size_t getRows() const { return mrows; }
+        /**
+         * @brief Indicates, weather the block has results.
+         * @param id        ID of the block.
+         * @returns True, if the block was evaluated.
+         */
+        bool has(long id) const { return mslots.count(id) > 0; }
+        /**
+         * @brief Value getter.
+         * @param id        ID of the block.
+         * @param row       Row.
+         * @returns Value of the block in the row.
+         */
+        double getValue(long id, size_t row) const { return mvalues[mslots.at(id)*mrows + row]; }
+        /**
+         * @brief Error getter.
+         * @param id        ID of the block.
+         * @param row       Row.
+         * @returns Error of the block in the row.
+         */
+        EvalError getError(long id, size_t row) const { return EvalError(merrors[mslots.at(id)*mrows + row]); }
+        /**
+         * @brief Error mask of the row.
+         * @param row       Row.
+         * @returns Mask of the errors of all the blocks in the row.
+         */
+        unsigned getRowMask(size_t row) const { return mrowmask[row]; }
+        /**
+         * @brief Error mask of the block.
+         * @param id        ID of the block.
+         * @returns Mask of the errors of the block in all the rows.
+         */
+        unsigned getBlockMask(long id) const { return mslotmask[mslots.at(id)]; }
+        /**
+         * @brief Count of the rows with an error.
+         * @returns Count of the erroneous rows.
+         */
+        size_t getErrorRows() const;
+
+    private:
+        friend class Plan;
+
+        size_t mrows = 0; /**< Count of rows. */
+        std::map<long,long> mslots; /**< Block ID to slot mapping. */
+        std::vector<double> mvalues; /**< Values, slot after slot (each has mrows values). */
+        std::vector<unsigned char> merrors; /**< Errors, same layout as values. */
+        std::vector<unsigned> mrowmask; /**< Error mask of each row. */
+        std::vector<unsigned> mslotmask; /**< Error mask of each slot. */
+};
+
+/**
+ * @brief Execution plan.
+ */
+class Plan
+{
+    public:
+        /**
+         * @brief Folded constant.
+         */
+        struct Constant
+        {
+            long slot; /**< Slot of the constant. */
+            double value; /**< Value. */
+            EvalError error; /**< Error of the evaluation. */
+        };
+
+        /**
+         * @brief Appends the input.
+         * @param id        ID of the input block.
+         * @param slot      Slot of the input in the model.
+         * @param v         Current value of the input.
+         * @param constant  True, if the value does not change between runs.
+         */
+        void addInput(long id, long slot, const Value& v, bool constant = false);
+        /**
+         * @brief Appends the block. Blocks must come in the topological order.
+         * @param id        ID of the block.
+         * @param type      Type of the block.
+         * @param in        Slots of the inputs in the model.
+         * @param slot      Slot of the output in the model.
+         * @param level     Level of the block.
+         * @returns False, if some input is not produced by the plan (block is skipped).
+         */
+        bool addBlock(long id, long type, const std::vector<long>& in, long slot, int level);
+
+        /**
+         * @brief Optimizes the plan. Blocks depending only on constant inputs
+         *        are evaluated once and kept as constants. Then the algebraic
+         *        identities are applied (see simplify()) and the identical blocks
+         *        are merged (see share()). Blocks, that do not
+         *        lead to any output, are dropped. Chains of the blocks with one
+         *        input, whose intermediate values are not outputs, are fused
+         *        into single nodes (see fuse()). Constant inputs are no more
+         *        among the input columns.
+         * @param outputs   IDs of the blocks selected for output. If empty, all
+         *                  the blocks are outputs.
+         */
+        void optimize(const std::set<long>& outputs);
+
+        /**
+         * @brief Input IDs getter.
+         * @returns IDs of the inputs in the order of the input columns.
+         */
+        const std::vector<long>& getInputs() const { return minputs; }
+        /**
+         * @brief Input slots getter.
+         * @returns Slots of the inputs in the order of the input columns.
+         */
+        const std::vector<long>& getInputSlots() const { return minslots; }
+        /**
+         * @brief Slots getter.
+         * @returns Block ID to slot mapping (the aliased blocks share the slot).
+         */
+        const std::map<long,long>& getSlots() const { return mslots; }
+        /**
+         * @brief Current values of the inputs.
+         * @returns Values in the order of the input columns.
+         */
+        const std::vector<double>& getDefaults() const { return mdefaults; }
+        /**
+         * @brief Nodes getter.
+         * @returns Nodes in the topological order.
+         */
+        const std::vector<PlanNode>& getNodes() const { return mnodes; }
+        /**
+         * @brief Slot count getter.
+         * @returns Count of the slots.
+         */
+        size_t getSlotCount() const { return mslotcount; }
+
+        /**
+         * @brief Evaluates the batch of rows.
+         * @param inputs    Input values, column after column (each has rows values),
+         *                  in the order of getInputs().
+         * @param rows      Count of the rows.
+         * @param r         Results (buffers are reused).
+         */
+        void evaluate(const std::vector<double>& inputs, size_t rows, BatchResults& r) const;
+        /**
+         * @brief Evaluates single row with the current values of the inputs.
+         * @param r         Results (buffers are reused).
+         */
+        void evaluate(BatchResults& r) const { evaluate(mdefaults, 1, r); }
+
+        /**
+         * @brief Constant count getter.
+         * @returns Count of the folded constants.
+         */
+        size_t getConstantCount() const { return mconstants.size(); }
+        /**
+         * @brief Constants getter.
+         * @returns Folded constants.
+         */
+        const std::vector<Constant>& getConstants() const { return mconstants; }
+        /**
+         * @brief Rewrites getter.
+         * @returns IDs of the rewritten blocks mapped to the IDs of the original
+         *          blocks, which they were made from.
+         */
+        const std::map<long,std::vector<long>>& getRewrites() const { return mrewrites; }
+
+    private:
+        std::vector<long> minputs; /**< IDs of the inputs. */
+        std::vector<long> minslots; /**< Slots of the inputs. */
+        std::vector<double> mdefaults; /**< Current values of the inputs. */
+        std::vector<bool> mconstinputs; /**< Constant flags of the inputs. */
+        std::vector<Constant> mconstants; /**< Folded constants. */
+        std::map<long,std::vector<long>> mrewrites; /**< Rewritten blocks to original blocks. */
+        std::vector<PlanNode> mnodes; /**< Nodes in the topological order. */
+        std::map<long,long> mslots; /**< Block ID to slot mapping. */
+        std::map<long,long> mmodelslots; /**< Model slot to slot mapping. */
+        std::vector<int> mtypes; /**< Type ids of the slots. */
+        size_t mslotcount = 0; /**< Count of slots. */
+
+        /**
+         * @brief Allocates the slot for the model slot.
+         * @param id        ID of the block.
+         * @param slot      Model slot.
+         * @param type      Type id of the value.
+         * @returns Allocated slot.
+         */
+        long allocate(long id, long slot, int type);
+        /**
+         * @brief Applies the algebraic identities of the built-in blocks:
+         *        neg(neg(x)) = x, x*1 = x, x/1 = x, x+0 = x, x-0 = x,
+         *        sqrt(squared(x)) = abs(x) and ln(ex(x)) = x. The blocks equal
+         *        to their input are aliased to the input slot (they report
+         *        the value and the error of the input). The composed blocks
+         *        fall back to the original functions out of the range, where
+         *        the identity holds, so the errors are kept.
+         * @param constant  Constant flags of the slots.
+         * @param once      Results of the single evaluation (constant values).
+         */
+        void simplify(const std::vector<bool>& constant, const BatchResults& once);
+        /**
+         * @brief Evaluates the identical blocks (same type, same input slots)
+         *        once. The duplicates are aliased to the slot of the first one.
+         * @param constant  Constant flags of the slots.
+         */
+        void share(const std::vector<bool>& constant);
+        /**
+         * @brief Fuses the chains of the blocks with one input into single
+         *        nodes, which keep the intermediate values in registers. The
+         *        intermediate values are not stored, an error inside the chain
+         *        ends it and is reported at its end (with its own code).
+         * @param nodes     Nodes to fuse (in the topological order).
+         * @param needed    Slots, that must be stored (reset for the fused ones).
+         * @param outputs   Slots of the outputs.
+         */
+        static void fuse(std::vector<PlanNode>& nodes, std::vector<bool>& needed, const std::vector<bool>& outputs);
+};
+
+#endif // PLAN_H
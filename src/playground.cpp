@@ -8,17 +8,31 @@
  * This module contains playground (workplace) implementation.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <set>
 #include <string>
 
+#include <QInputDialog>
 #include <QMouseEvent>
 #include <QPainter>
+#include <QWheelEvent>
 
 #include "debug.h"
 #include "playground.h"
 
 // prehodit mosepressevent do sceny -> oprava view
 // guiblock subclasses podle poctu vstupu a vystupu
+namespace {
+    /** @brief Smallest zoom of the view. */
+    const double MinZoom = 0.05;
+    /** @brief Largest zoom of the view. */
+    const double MaxZoom = 4;
+    /** @brief Zoom of one step of the wheel. */
+    const double ZoomStep = 1.15;
+}
+
 template<class T>
 void printNOISOMap(T a)
 {
@@ -42,6 +56,7 @@ PlayGround::PlayGround(QWidget* parent): QWidget(parent)
   // scene is 3000*3000 pixels big. Hopefully it is enough.
   mscene->setSceneRect(0, 0, 3000, 3000);
   mview->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+  QObject::connect(mview, SIGNAL(sigZoomChanged(double)), this, SLOT(slotZoom(double)));
 
   QVBoxLayout *layout = new QVBoxLayout();
   layout->addWidget(mview);
@@ -58,6 +73,7 @@ void PlayGround::reinit()
     for(auto& it: mWires) {
         for(auto& i: it.second->getLine()) { mscene->removeItem(i.get()); }
         mscene->removeItem(it.second->getText());
+        mscene->removeItem(it.second->getPolyline());
     }
     for(auto& it: mInputs) { mscene->removeItem(it.second.get()); }
     mBlocks.clear();
@@ -69,7 +85,7 @@ void PlayGround::reinit()
 
 void PlayGround::setWireValue(long id, Value v)
 {
-    Debug::Compute("PlayGround::setWireValue("+std::to_string(id)+")");
+    Debug::Compute("PlayGround::setWireValue()", id);
     std::shared_ptr<MyWire> wire = mWires[id];
 
     wire.get()->setValue(v);
@@ -80,7 +96,7 @@ void PlayGround::setWireValue(long id, Value v)
 }
 void PlayGround::setBlockValue(long id, Value v)
 {
-    Debug::Compute("PlayGround::setBlockValue("+std::to_string(id)+")");
+    Debug::Compute("PlayGround::setBlockValue()", id);
     if(mInputs.count(id) > 0) { return; }   // model cannot change value of input
 
     std::shared_ptr<GuiBlock> block = mBlocks.at(id);
@@ -90,6 +106,36 @@ void PlayGround::setBlockValue(long id, Value v)
     wire.get()->getText()->setPlainText(QString::fromStdString(std::to_string(newValue)));
 */
 }
+void PlayGround::setWireStats(long id, const std::string& s)
+{
+    if(mWires.count(id) > 0) mWires.at(id)->setStats(s);
+}
+void PlayGround::setBlockStats(long id, const std::string& s)
+{
+    if(mInputs.count(id) > 0) mInputs.at(id)->setStats(s);
+    else if(mBlocks.count(id) > 0) mBlocks.at(id)->setStats(s);
+}
+void PlayGround::setBlockHeat(long id, double heat, const std::string& cost)
+{
+    if(mBlocks.count(id) > 0) mBlocks.at(id)->setHeat(heat, cost);
+}
+void PlayGround::clearHeat()
+{
+    for(auto& x: mBlocks)
+    {
+        x.second->setHeat(-1, "");
+    }
+}
+void PlayGround::accountMemory(MemoryReport& r) const
+{
+    r.addMap(mBlocks);
+    r.addMap(mInputs);
+    r.addMap(mWires);
+    std::set<qint64> pixmaps;
+    for(auto& it: mBlocks) { it.second->accountMemory(r, pixmaps); }
+    for(auto& it: mInputs) { it.second->accountMemory(r); }
+    for(auto& it: mWires) { it.second->accountMemory(r); }
+}
 void PlayGround::setWireColor(long id, bool active)
 {
     std::shared_ptr<MyWire> wire = mWires[id];
@@ -103,6 +149,19 @@ void PlayGround::setBlockColor(long id, bool active)
     std::shared_ptr<GuiBlock> block = mBlocks[id];
     block.get()->setColor(active);
 }
+void PlayGround::setComputing(bool v)
+{
+    mcompute = v;
+    // the model may be evaluated in the background, it must not change
+    Qt::MouseButtons buttons = v ? Qt::NoButton : Qt::AllButtons;
+    for(auto& it: mBlocks) { it.second->setAcceptedMouseButtons(buttons); }
+    for(auto& it: mInputs) { it.second->setAcceptedMouseButtons(buttons); }
+    for(auto& it: mWires)
+    {
+        for(auto& i: it.second->getLine()) { i->setAcceptedMouseButtons(buttons); }
+        it.second->getPolyline()->setAcceptedMouseButtons(buttons);
+    }
+}
 void PlayGround::setAllDefaultColor()
 {
     for(auto& x: mWires)
@@ -135,6 +194,8 @@ void PlayGround::slotViewLeftClick(QMouseEvent *event)
 
     // umisteni dratu - K CEMU TO JE DOBRE??? Draty tvorim klikem na blok, ne na playground
     if(mcompute) return;
+    // the view may be zoomed and scrolled
+    QPointF pos = mview->mapToScene(event->pos());
     if(mwire)
     {
 
@@ -142,8 +203,9 @@ void PlayGround::slotViewLeftClick(QMouseEvent *event)
     // umisteni vstupu
     else if(minput)
     {
-        std::shared_ptr<GuiInput> newInput = std::make_shared<GuiInput>(event->pos());
+        std::shared_ptr<GuiInput> newInput = std::make_shared<GuiInput>(pos);
         if(!newInput->isOk()) return;
+        newInput->setDetail(mdetail);
         mscene->addItem(newInput.get());
 
 
@@ -158,8 +220,9 @@ void PlayGround::slotViewLeftClick(QMouseEvent *event)
 
         long id;
         emit sigCreateInput(newInput->getValue(), id);
+        emit sigInputConstantChanged(id, newInput->isConstant());
 
-        Debug::Gui("Create block "+std::to_string(id));
+        Debug::Gui("Create block", id);
 
         mmapper.setMapping(newInput.get(), id);
         QObject::connect(newInput.get(), SIGNAL(sigBlockClick()),
@@ -173,8 +236,18 @@ void PlayGround::slotViewLeftClick(QMouseEvent *event)
     // umisteni krabicky
     else if(mchoice >= 0)
     {
+        // input count of the block with N inputs
+        int ports = 0;
+        if(Config::decodeBlockType(mchoice) == BlockType::NIn_OneOut)
+        {
+            bool ok;
+            ports = QInputDialog::getInt(0, "Input count", "Input count:", 2, 2, 4096, 1, &ok);
+            if(!ok) return;
+        }
+
         // create guiblock
-        std::shared_ptr<GuiBlock> newBlock = std::make_shared<GuiBlock>(event->pos(), mchoice);
+        std::shared_ptr<GuiBlock> newBlock = std::make_shared<GuiBlock>(pos, mchoice, ports);
+        newBlock->setDetail(mdetail);
         mscene->addItem(newBlock.get());
 
         // collisions
@@ -188,9 +261,9 @@ void PlayGround::slotViewLeftClick(QMouseEvent *event)
 
         // poslat zadost o id modelu
         long id; /**< Tady budes mit to id z modelu */
-        emit sigCreateBlock(mchoice, id);
+        emit sigCreateBlock(mchoice, ports, id);
 
-        Debug::Gui("Create block "+std::to_string(id));
+        Debug::Gui("Create block", id);
 
         // map signals
         mmapper.setMapping(newBlock.get(), id);
@@ -241,7 +314,7 @@ bool PlayGround::createWireFunction()
     if(block2 == nullptr) end = getIDFromInput(iblock2);
     else end = getIDFromBlock(block2);
     //std::cout << begin <<" "<< connector1 <<" "<< end <<" "<< connector2 << std::endl;
-    Debug::Gui("Create wire: "+std::to_string(begin)+"<->"+std::to_string(end));
+    Debug::Gui("Create wire", begin, end);
     emit sigCreateWire({/*getIDFromBlock(block1)*/begin,connector1}, {/*getIDFromBlock(block2)*/end,connector2}, id, success);
     if(!success) return false;
 
@@ -260,6 +333,8 @@ bool PlayGround::createWireFunction()
     // draw wire
     for(auto& it: newWire->getLine()) { mscene->addItem(it.get()); }
     mscene->addItem(newWire->getText());
+    mscene->addItem(newWire->getPolyline());
+    newWire->setDetail(mdetail);
 
     QObject::connect(newWire.get(), SIGNAL(sigForkWire(long, QPointF)),
                      this, SLOT(slotForkWire(long, QPointF)));
@@ -271,7 +346,7 @@ bool PlayGround::createWireFunction()
 
 void PlayGround::deleteWireFunction(long i)
 {
-    Debug::Gui( "PlayGround::deleteWireFunction("+std::to_string(i)+")" );
+    Debug::Gui("PlayGround::deleteWireFunction()", i);
     emit sigDeleteWire(i);
     std::shared_ptr<MyWire> wire = mWires.at(i);
 
@@ -282,18 +357,20 @@ void PlayGround::deleteWireFunction(long i)
 
     for(auto& it: wire->getLine()) { mscene->removeItem(it.get()); }
     mscene->removeItem(wire->getText());
+    mscene->removeItem(wire->getPolyline());
     mWires.erase(i);
 }
 
 void PlayGround::slotDeleteWire(long id)
 {
-    Debug::Events("Deleting wire "+std::to_string(id));
+    Debug::Events("Deleting wire", id);
+    if(mcompute) return;
     deleteWireFunction(id);
 }
 
 void PlayGround::slotForkWire(long id, QPointF)
 {
-    Debug::Events("Forking wire "+std::to_string(id));
+    Debug::Events("Forking wire", id);
 }
 
 
@@ -302,7 +379,7 @@ void PlayGround::slotForkWire(long id, QPointF)
 
 void PlayGround::inputClick(int i)
 {
-    Debug::Events("PlayGround::inputClick "+std::to_string(i));
+    Debug::Events("PlayGround::inputClick", i);
     if(mInputs.at(i)->getMouseEvent()->button() == Qt::RightButton)
     {
         emit sigDeleteBlock(i);
@@ -356,6 +433,7 @@ void PlayGround::inputClick(int i)
 
 void PlayGround::slotBlockClick(int i)
 {
+    if(mcompute) return;
     QGraphicsSceneMouseEvent * event;
     if(mInputs.count(i) > 0) { inputClick(i); return; }
     auto block = mBlocks.at(i);
@@ -363,7 +441,7 @@ void PlayGround::slotBlockClick(int i)
 
     if(event->button() == Qt::LeftButton)
     {
-        Debug::Events("PlayGround: Left click from block "+std::to_string(i));
+        Debug::Events("PlayGround: Left click from block", i);
 
         // wire selected ...
         if(mwire)
@@ -380,7 +458,7 @@ void PlayGround::slotBlockClick(int i)
             }
             else
             {
-                if(connector > 1 || connector < -1) return;
+                if(connector >= block->getInputCount() || connector < -1) return;
                 block2 = block;
                 connector2 = connector;
                 createWire = createWire && wireFree;
@@ -406,7 +484,7 @@ void PlayGround::slotBlockClick(int i)
     }
     else if(event->button() == Qt::RightButton) // delete block
     {
-        Debug::Events("PlayGround: Right click, deleting block "+std::to_string(i));
+        Debug::Events("PlayGround: Right click, deleting block", i);
         emit sigDeleteBlock(i);     // mapper mi neumoznuje posilat long, jen int
         mscene->removeItem(block.get());
         mBlocks.erase(i);
@@ -414,6 +492,33 @@ void PlayGround::slotBlockClick(int i)
 }
 
 
+void PlayGround::slotZoom(double zoom)
+{
+    bool detail = zoom >= GuiBlock::LowDetail;
+    if(detail == mdetail) return;
+    Debug::Gui("PlayGround::slotZoom(detail)", detail);
+    mdetail = detail;
+    for(auto& it: mBlocks) { it.second->setDetail(detail); }
+    for(auto& it: mInputs) { it.second->setDetail(detail); }
+    for(auto& it: mWires) { it.second->setDetail(detail); }
+}
+
+void PlayGroundView::wheelEvent(QWheelEvent *event)
+{
+    if(!(event->modifiers() & Qt::ControlModifier))
+    {
+        QGraphicsView::wheelEvent(event);
+        return;
+    }
+    // one step of the wheel is 120
+    double zoom = getZoom() * std::pow(ZoomStep, event->angleDelta().y() / 120.0);
+    zoom = std::max(MinZoom, std::min(MaxZoom, zoom));
+    setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+    scale(zoom / getZoom(), zoom / getZoom());
+    event->accept();
+    emit sigZoomChanged(zoom);
+}
+
 void PlayGroundView::mousePressEvent(QMouseEvent *event)
 {
     if(event->button() == Qt::LeftButton)
@@ -438,6 +543,7 @@ std::map<long,GuiBlockDescriptor> PlayGround::getBlockState()
     {
         GuiBlockDescriptor d;
         d.type = it.second->getType();
+        d.ports = it.second->getInputCount();
         d.pos.first = it.second->x() + it.second->getWidth()/2;
         d.pos.second = it.second->y() + it.second->getHeight()/2;
         d.val.type = "nepodstatne";
@@ -454,6 +560,7 @@ std::map<long,GuiBlockDescriptor> PlayGround::getBlockState()
         d.val.type = it.second->getValue().type;
         d.val.valid = it.second->getValue().valid;
         d.val.value = it.second->getValue().value;
+        d.constant = it.second->isConstant();
         m.insert( std::make_pair(it.first,d) );
     }
     return m;
@@ -496,7 +603,9 @@ void PlayGround::setBlockState(std::map<long,GuiBlockDescriptor> m)
             val.valid = it.second.val.valid;
             val.value = it.second.val.value;
             std::shared_ptr<GuiInput> newInput = std::make_shared<GuiInput>(pos, true);
+            newInput->setDetail(mdetail);
             newInput->setValue(val);
+            newInput->setConstant(it.second.constant);
             mscene->addItem(newInput.get());
 
             mmapper.setMapping(newInput.get(), id);
@@ -505,10 +614,12 @@ void PlayGround::setBlockState(std::map<long,GuiBlockDescriptor> m)
 
             mInputs.insert( std::make_pair(id,newInput) );
             emit sigInputValueChanged(id, val);
+            emit sigInputConstantChanged(id, it.second.constant);
         }
         else
         {
-            std::shared_ptr<GuiBlock> newBlock = std::make_shared<GuiBlock>(pos, type);
+            std::shared_ptr<GuiBlock> newBlock = std::make_shared<GuiBlock>(pos, type, it.second.ports);
+            newBlock->setDetail(mdetail);
             mscene->addItem(newBlock.get());
 
             mmapper.setMapping(newBlock.get(), id);
@@ -563,9 +674,11 @@ void PlayGround::setWireState(std::vector<struct wireState> v)
 void PlayGround::slotValueChanged()
 {
     Debug::Gui("PlayGround::slotValueChanged");
+    if(mcompute) return;
     for(auto& it: mInputs)
     {
         emit sigInputValueChanged(it.first, it.second->getValue());
+        emit sigInputConstantChanged(it.first, it.second->isConstant());
         //std::cerr << "Value of " << it.first << " is " << it.second->getValue().value << "\n";
     }
 }
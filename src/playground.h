@@ -117,6 +117,34 @@ class PlayGround: public QWidget
          * @param   newValue    new value
          */
         void setBlockValue(long id, Value v);
+        /**
+         * @brief   Sets the statistics of a wire for display (tooltip).
+         * @param   id          ID of the wire
+         * @param   s           description of the statistics
+         */
+        void setWireStats(long id, const std::string& s);
+        /**
+         * @brief   Sets the statistics of a block for display (tooltip).
+         * @param   id          ID of the block
+         * @param   s           description of the statistics
+         */
+        void setBlockStats(long id, const std::string& s);
+        /**
+         * @brief   Sets the heat of a block (profiling).
+         * @param   id          ID of the block
+         * @param   heat        relative cost in [0,1]
+         * @param   cost        description of the cost (tooltip)
+         */
+        void setBlockHeat(long id, double heat, const std::string& cost);
+        /**
+         * @brief   Removes the heat of all the blocks.
+         */
+        void clearHeat();
+        /**
+         * @brief   Adds the memory of the items (blocks, inputs, wires) to the report.
+         * @param   r           report
+         */
+        void accountMemory(MemoryReport& r) const;
         /**
          * @brief   Sets new color of a wire for display.
          * @param   id          ID of the wire
@@ -138,10 +166,11 @@ class PlayGround: public QWidget
          */
         void clearComputation();
         /**
-         * @brief   Computing bit setter.
+         * @brief   Computing bit setter. While computing, the items do not accept
+         *          the mouse buttons (the tooltips are shown), so the scheme is not edited.
          * @param v         True if computing.
          */
-        void setComputing(bool v) { mcompute = v; }
+        void setComputing(bool v);
 
     public slots:
         /**
@@ -185,6 +214,12 @@ class PlayGround: public QWidget
          * @brief   Slot for signal, that value changed.
          */
         void slotValueChanged();
+        /**
+         * @brief   Slot for PlayGroundView's signal, zoom changed. Simplifies the
+         *          items under GuiBlock::LowDetail.
+         * @param   zoom     New zoom.
+         */
+        void slotZoom(double zoom);
 
     signals:
         /**
@@ -196,9 +231,10 @@ class PlayGround: public QWidget
          * @brief   Graphic's signal to the model, that block has been created.
          *          The generated id (in the model) is passed by key.
          * @param type      Type of created block.
+         * @param ports     Count of inputs (only for blocks with N inputs).
          * @param key       Reference for passing a key (backwards).
          */
-        void sigCreateBlock(long type, long& key);
+        void sigCreateBlock(long type, int ports, long& key);
         /**
          * @brief   Graphic's signal to the model, that input has been created.
          *          The generated id (in the model) is passed by key.
@@ -212,6 +248,12 @@ class PlayGround: public QWidget
          * @param value     New value.
          */
         void sigInputValueChanged(long key, Value value);
+        /**
+         * @brief   Graphic's signal to the model, that input was marked constant or variable.
+         * @param key       Key of input.
+         * @param constant  True, if constant.
+         */
+        void sigInputConstantChanged(long key, bool constant);
         /**
          * @brief   Graphic's signal to the model, that block is deleted.
          * @param key       Key of deleted block.
@@ -247,6 +289,7 @@ class PlayGround: public QWidget
         bool mwire = false; /**< Weather the wire is being placed. */
         bool minput = false; /**< Weather the input is being placed. */
         bool mcompute = false; /**< Weather computing. */
+        bool mdetail = true; /**< Zoomed over GuiBlock::LowDetail. */
         void annulateChoice() { mchoice = -1; mwire = minput = false; }
 
         std::map<long, std::shared_ptr<GuiBlock>> mBlocks; /**< Placed blocks. */
@@ -287,6 +330,16 @@ class PlayGroundView: public QGraphicsView
          * @param event     Description of event.
          */  
         void mousePressEvent(QMouseEvent *event);
+        /**
+         * @brief   Wheel handler. Zooms with Ctrl, scrolls otherwise.
+         * @param event     Description of event.
+         */
+        void wheelEvent(QWheelEvent *event);
+        /**
+         * @brief   Zoom getter.
+         * @returns Scale of the view.
+         */
+        double getZoom() const { return transform().m11(); }
 
     signals:
         /**
@@ -297,6 +350,11 @@ class PlayGroundView: public QGraphicsView
          * @brief   Signal to the PlayGround, right click.
          */
         void sigViewRightClick(QMouseEvent *event);
+        /**
+         * @brief   Signal to the PlayGround, zoom changed.
+         * @param zoom      New zoom.
+         */
+        void sigZoomChanged(double zoom);
     
 };
 
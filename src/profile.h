@@ -0,0 +1,48 @@
+/**
+ * @file profile.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief profiling of the blocks
+ *
+ * This module switches the profiling of the blocks. When it is on, every
+ * block measures the time of its computation and adds it to its cost
+ * (IBlock::getCost), the costs are accumulated over the runs. When it is
+ * off, the block pays only for one load of the switch.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <atomic>
+#include <chrono>
+
+/**
+ * @brief Namespace of the profiling.
+ */
+namespace Profile
+{
+    /** @brief Profiling is on. */
+    inline std::atomic<bool> Enabled(false);
+
+    /**
+     * @brief Profiling getter.
+     * @returns True, if the blocks are profiled.
+     */
+    inline bool isEnabled() { return Enabled.load(std::memory_order_relaxed); }
+    /**
+     * @brief Profiling setter.
+     * @param on        Profiling is on, if true.
+     */
+    inline void setEnabled(bool on) { Enabled.store(on, std::memory_order_relaxed); }
+    /**
+     * @brief Time getter.
+     * @returns Monotonic time in nanoseconds.
+     */
+    inline unsigned long long now()
+    {
+        return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+#endif // PROFILE_H
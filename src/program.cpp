@@ -0,0 +1,292 @@
+/**
+ * @file program.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief bytecode program module
+ *
+ * This module contains the bytecode compiler and interpreter.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "debug.h"
+#include "defs.h"
+#include "program.h"
+
+namespace {
+    /** @brief Names of the operations, in the order of Opcode. */
+    const char* OpNames[OpCount] = {
+        "adder", "subtractor", "multiplier", "divider",
+        "ex", "abs", "ln", "neg", "sign", "squared", "sqrt",
+        "sum", "product", "min", "max",
+        "sqrtofsquared", "logofexp"
+    };
+
+    /**
+     * @brief Maps the type of the plan node to the operation.
+     * @param type      Type of the block (or PlanNodeType).
+     * @returns Operation.
+     */
+    Opcode getOpcode(long type)
+    {
+        if(type == PlanNodeType::SqrtOfSquared) return OpSqrtOfSquared;
+        if(type == PlanNodeType::LogOfExp) return OpLogOfExp;
+        std::string name = Config::getBlockName(type);
+        for(int i = 0; i < OpCount; i++) { if(name == OpNames[i]) return Opcode(i); }
+        throw MyError("Block "+name+" has no instruction", ErrorType::BlockError);
+    }
+
+    /**
+     * @brief Splits the line of the file by commas.
+     * @param s         Line.
+     * @returns Fields.
+     */
+    std::vector<std::string> fields(const std::string& s)
+    {
+        std::vector<std::string> v;
+        std::istringstream is(s);
+        std::string f;
+        while(std::getline(is, f, ',')) v.push_back(f);
+        return v;
+    }
+}
+
+const char* Program::getOpName(Opcode op) { return OpNames[op]; }
+
+Program Program::compile(const Plan& p)
+{
+    Debug::Span span(Debug::TraceCompute, "Program::compile()");
+    Program prg;
+    for(size_t i = 0; i < p.getInputs().size(); i++)
+    {
+        prg.minputs.push_back(p.getInputs()[i]);
+        prg.minregs.push_back(unsigned(p.getInputSlots()[i]));
+    }
+    prg.mconstants = p.getConstants();
+
+    for(auto& n: p.getNodes())
+    {
+        if(n.type == PlanNodeType::Fused)
+        {
+            // the links of the chain go through the destination register
+            unsigned src = unsigned(n.in[0]);
+            for(auto& it: n.chain)
+            {
+                prg.mcode.push_back({getOpcode(it.type), unsigned(n.out), src, 0});
+                src = unsigned(n.out);
+            }
+            continue;
+        }
+
+        Instruction ins = {getOpcode(n.type), unsigned(n.out), 0, 0};
+        switch(n.kind)
+        {
+            case BlockType::OneIn_OneOut:
+                ins.a = unsigned(n.in[0]);
+                break;
+            case BlockType::TwoIn_OneOut:
+                ins.a = unsigned(n.in[0]);
+                ins.b = unsigned(n.in[1]);
+                break;
+            case BlockType::NIn_OneOut:
+                ins.a = unsigned(prg.moperands.size());
+                ins.b = unsigned(n.in.size());
+                for(auto& it: n.in) { prg.moperands.push_back(unsigned(it)); }
+                break;
+        }
+        prg.mcode.push_back(ins);
+    }
+
+    for(auto& it: p.getSlots())
+    {
+        prg.moutputs.push_back(it.first);
+        prg.moutregs.push_back(unsigned(it.second));
+    }
+    prg.mregs.resize(p.getSlotCount());
+    prg.prepare();
+    return prg;
+}
+
+void Program::prepare()
+{
+    // every register must exist
+    size_t n = mregs.size();
+    auto check = [n](unsigned r) {
+        if(r >= n) throw MyError("Register out of range", ErrorType::BlockError);
+    };
+    for(auto& it: minregs) check(it);
+    for(auto& it: moutregs) check(it);
+    for(auto& it: moperands) check(it);
+    for(auto& it: mconstants) check(unsigned(it.slot));
+    size_t args = 0;
+    for(auto& it: mcode)
+    {
+        if(it.op >= OpCount) throw MyError("Unknown instruction", ErrorType::BlockError);
+        check(it.dst);
+        if(it.op >= OpSum && it.op <= OpMax)
+        {
+            if(it.b == 0 || size_t(it.a) + it.b > moperands.size())
+                throw MyError("Operands out of range", ErrorType::BlockError);
+            args = std::max(args, size_t(it.b));
+        }
+        else
+        {
+            check(it.a);
+            if(it.op <= OpDiv) check(it.b);
+        }
+    }
+    merrs.assign(n, EvalError::EvalOk);
+    margs.resize(args);
+}
+
+void Program::run(const double* inputs, double* outputs, EvalError* errors)
+{
+    double* r = mregs.data();
+    unsigned char* e = merrs.data();
+    for(size_t i = 0; i < minregs.size(); i++)
+    {
+        r[minregs[i]] = inputs[i];
+        e[minregs[i]] = EvalError::EvalOk;
+    }
+    for(auto& it: mconstants)
+    {
+        r[it.slot] = it.value;
+        e[it.slot] = it.error;
+    }
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for(auto& ins: mcode)
+    {
+        // poisoned by the erroneous operand
+        bool poisoned;
+        if(ins.op <= OpDiv) poisoned = e[ins.a] != EvalError::EvalOk || e[ins.b] != EvalError::EvalOk;
+        else if(ins.op >= OpSum && ins.op <= OpMax)
+        {
+            poisoned = false;
+            for(unsigned k = 0; k < ins.b; k++)
+            {
+                unsigned reg = moperands[ins.a + k];
+                poisoned = poisoned || e[reg] != EvalError::EvalOk;
+                margs[k] = r[reg];
+            }
+        }
+        else poisoned = e[ins.a] != EvalError::EvalOk;
+        if(poisoned)
+        {
+            r[ins.dst] = nan;
+            // the link of the fused chain (in place) keeps the error of the failed link
+            bool inplace = ins.op > OpDiv && !(ins.op >= OpSum && ins.op <= OpMax) && ins.a == ins.dst;
+            if(!inplace) e[ins.dst] = EvalError::Poisoned;
+            continue;
+        }
+
+        EvalError err = EvalError::EvalOk;
+        bool reduction = ins.op >= OpSum && ins.op <= OpMax;
+        double x = reduction ? 0 : r[ins.a];
+        double y = (ins.op <= OpDiv) ? r[ins.b] : 0;
+        double v = apply(ins.op, x, y, margs.data(), ins.b, err);
+        r[ins.dst] = v;
+        e[ins.dst] = err;
+    }
+
+    for(size_t i = 0; i < moutregs.size(); i++)
+    {
+        outputs[i] = r[moutregs[i]];
+        if(errors != nullptr) errors[i] = EvalError(e[moutregs[i]]);
+    }
+}
+
+std::string Program::listing() const
+{
+    std::ostringstream os;
+    for(auto& ins: mcode)
+    {
+        os << "r" << ins.dst << " = " << OpNames[ins.op];
+        if(ins.op >= OpSum && ins.op <= OpMax)
+        {
+            for(unsigned k = 0; k < ins.b; k++) os << " r" << moperands[ins.a + k];
+        }
+        else
+        {
+            os << " r" << ins.a;
+            if(ins.op <= OpDiv) os << " r" << ins.b;
+        }
+        os << "\n";
+    }
+    return os.str();
+}
+
+void Program::save(const std::string& path) const
+{
+    Debug::Compute("Program::save()");
+    std::ofstream os(path);
+    if(!os) throw MyError("Cannot write "+path, ErrorType::BlockError);
+    // hexadecimal floats are read back exactly
+    os << std::hexfloat;
+    os << "# PROGRAM #\n" << mregs.size() << "\n";
+    os << "# INPUTS #\n";
+    for(size_t i = 0; i < minputs.size(); i++) os << minputs[i] << "," << minregs[i] << "\n";
+    os << "# CONSTANTS #\n";
+    for(auto& it: mconstants) os << it.slot << "," << it.value << "," << int(it.error) << "\n";
+    os << "# CODE #\n";
+    for(auto& it: mcode) os << OpNames[it.op] << "," << it.dst << "," << it.a << "," << it.b << "\n";
+    os << "# OPERANDS #\n";
+    for(auto& it: moperands) os << it << "\n";
+    os << "# OUTPUTS #\n";
+    for(size_t i = 0; i < moutputs.size(); i++) os << moutputs[i] << "," << moutregs[i] << "\n";
+}
+
+Program Program::load(const std::string& path)
+{
+    Debug::Compute("Program::load()");
+    std::ifstream is(path);
+    std::string s;
+    if(!std::getline(is, s) || s != "# PROGRAM #") throw MyError("Invalid program file", ErrorType::BlockError);
+
+    Program prg;
+    std::string section = "# PROGRAM #";
+    try {
+        while(std::getline(is, s))
+        {
+            if(s == "") continue;
+            if(s[0] == '#') { section = s; continue; }
+            std::vector<std::string> v = fields(s);
+            if(section == "# PROGRAM #") prg.mregs.resize(std::stoul(v.at(0)));
+            else if(section == "# INPUTS #")
+            {
+                prg.minputs.push_back(std::stol(v.at(0)));
+                prg.minregs.push_back(unsigned(std::stoul(v.at(1))));
+            }
+            else if(section == "# CONSTANTS #")
+            {
+                int err = std::stoi(v.at(2));
+                if(err < 0 || err > EvalError::Poisoned) throw MyError("Unknown error", ErrorType::BlockError);
+                prg.mconstants.push_back({std::stol(v.at(0)), std::strtod(v.at(1).c_str(), nullptr), EvalError(err)});
+            }
+            else if(section == "# CODE #")
+            {
+                Instruction ins = {OpCount, 0, 0, 0};
+                for(int i = 0; i < OpCount; i++) { if(v.at(0) == OpNames[i]) ins.op = Opcode(i); }
+                ins.dst = unsigned(std::stoul(v.at(1)));
+                ins.a = unsigned(std::stoul(v.at(2)));
+                ins.b = unsigned(std::stoul(v.at(3)));
+                prg.mcode.push_back(ins);
+            }
+            else if(section == "# OPERANDS #") prg.moperands.push_back(unsigned(std::stoul(v.at(0))));
+            else if(section == "# OUTPUTS #")
+            {
+                prg.moutputs.push_back(std::stol(v.at(0)));
+                prg.moutregs.push_back(unsigned(std::stoul(v.at(1))));
+            }
+        }
+    } catch(std::exception& e) {
+        throw MyError("Invalid program file", ErrorType::BlockError);
+    }
+    prg.prepare();
+    return prg;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file program.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief bytecode program interface
+ *
+ * This module contains the register bytecode of the scheme. The plan
+ * is compiled into the instructions over a register file, for example
+ * "r5 = adder r1 r3". The program is evaluated by a switch dispatch loop,
+ * without any allocation, and it may be saved and loaded, so the scheme
+ * can be evaluated without building the blocks.
+ */
+
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "plan.h"
+
+/**
+ * @brief Operation codes of the instructions.
+ */
+enum Opcode : unsigned char
+{
+    OpAdd, OpSub, OpMul, OpDiv,
+    OpExp, OpAbs, OpLog, OpNeg, OpSign, OpSquare, OpSqrt,
+    OpSum, OpProduct, OpMin, OpMax,
+    OpSqrtOfSquared, OpLogOfExp,
+    OpCount /**< Count of the operations (not an operation). */
+};
+
+/**
+ * @brief Instruction. The reductions take their operands from the operand
+ *        list (a is the index of the first, b is the count).
+ */
+struct Instruction
+{
+    Opcode op; /**< Operation. */
+    unsigned dst; /**< Destination register. */
+    unsigned a; /**< First operand register. */
+    unsigned b; /**< Second operand register. */
+};
+
+/**
+ * @brief Bytecode program of the scheme.
+ */
+class Program
+{
+    public:
+        /**
+         * @brief Compiles the plan. The slots of the plan are the registers.
+         * @param p         Plan.
+         * @returns Program.
+         */
+        static Program compile(const Plan& p);
+        /**
+         * @brief Loads the program from the file.
+         * @param path      Path to the file.
+         * @returns Program.
+         */
+        static Program load(const std::string& path);
+        /**
+         * @brief Saves the program to the file.
+         * @param path      Path to the file.
+         */
+        void save(const std::string& path) const;
+
+        /**
+         * @brief Evaluates the program. Uses the register file of the program,
+         *        so it does not allocate (and one program must not be run by
+         *        more threads at once).
+         * @param inputs    Values of the inputs, in the order of getInputs().
+         * @param outputs   Values of the outputs, in the order of getOutputs().
+         * @param errors    Errors of the outputs (may be nullptr).
+         */
+        void run(const double* inputs, double* outputs, EvalError* errors = nullptr);
+
+        /**
+         * @brief Input IDs getter.
+         * @returns IDs of the input blocks.
+         */
+        const std::vector<long>& getInputs() const { return minputs; }
+        /**
+         * @brief Output IDs getter.
+         * @returns IDs of the output blocks.
+         */
+        const std::vector<long>& getOutputs() const { return moutputs; }
+        /**
+         * @brief Input registers getter.
+         * @returns Registers of the inputs.
+         */
+        const std::vector<unsigned>& getInputRegisters() const { return minregs; }
+        /**
+         * @brief Output registers getter.
+         * @returns Registers of the outputs.
+         */
+        const std::vector<unsigned>& getOutputRegisters() const { return moutregs; }
+        /**
+         * @brief Operands getter.
+         * @returns Operand registers of the reductions.
+         */
+        const std::vector<unsigned>& getOperands() const { return moperands; }
+        /**
+         * @brief Constants getter.
+         * @returns Constants (slot is the register).
+         */
+        const std::vector<Plan::Constant>& getConstants() const { return mconstants; }
+        /**
+         * @brief Instructions getter.
+         * @returns Instructions in the order of evaluation.
+         */
+        const std::vector<Instruction>& getCode() const { return mcode; }
+        /**
+         * @brief Register count getter.
+         * @returns Count of the registers.
+         */
+        size_t getRegisterCount() const { return mregs.size(); }
+        /**
+         * @brief Lists the program in readable form.
+         * @returns One instruction per line.
+         */
+        std::string listing() const;
+
+        /**
+         * @brief Name of the operation (used in the file).
+         * @param op        Operation.
+         * @returns Name.
+         */
+        static const char* getOpName(Opcode op);
+        /**
+         * @brief Applies the operation (same math as the block functions).
+         * @param op        Operation.
+         * @param x         First operand.
+         * @param y         Second operand (operations with two operands).
+         * @param args      Operands of the reduction.
+         * @param n         Count of the operands of the reduction.
+         * @param err       Error of the operation.
+         * @returns Value.
+         */
+        static double apply(Opcode op, double x, double y, const double* args, unsigned n, EvalError& err);
+
+    private:
+        std::vector<long> minputs; /**< IDs of the inputs. */
+        std::vector<unsigned> minregs; /**< Registers of the inputs. */
+        std::vector<long> moutputs; /**< IDs of the outputs. */
+        std::vector<unsigned> moutregs; /**< Registers of the outputs. */
+        std::vector<Instruction> mcode; /**< Instructions. */
+        std::vector<unsigned> moperands; /**< Operands of the reductions. */
+        std::vector<Plan::Constant> mconstants; /**< Constants (slot is the register). */
+
+        std::vector<double> mregs; /**< Register file. */
+        std::vector<unsigned char> merrs; /**< Errors of the registers. */
+        std::vector<double> margs; /**< Arguments of the reduction. */
+
+        /**
+         * @brief Allocates the register file and checks the registers.
+         */
+        void prepare();
+};
+
+inline double Program::apply(Opcode op, double x, double y, const double* args, unsigned n, EvalError& err)
+{
+    double v = 0;
+    switch(op)
+    {
+        case OpAdd: v = x + y; break;
+        case OpSub: v = x - y; break;
+        case OpMul: v = x * y; break;
+        case OpDiv: if(y == 0) err = DivisionByZero; v = x / y; break;
+        case OpExp: v = exp(x); break;
+        case OpAbs: v = fabs(x); break;
+        case OpLog: if(x <= 0) err = NonPositiveLogarithm; v = log(x); break;
+        case OpNeg: v = -x; break;
+        case OpSign: v = (x>0)?1:((x<0)?-1:0); break;
+        case OpSquare: v = x * x; break;
+        case OpSqrt: if(x < 0) err = NegativeSquareRoot; v = sqrt(x); break;
+        case OpSum: v = Config::reduce(args, n, [](double a, double b){return a+b;}); break;
+        case OpProduct: v = Config::reduce(args, n, [](double a, double b){return a*b;}); break;
+        case OpMin: v = Config::reduce(args, n, [](double a, double b){return (b<a)?b:a;}); break;
+        case OpMax: v = Config::reduce(args, n, [](double a, double b){return (b>a)?b:a;}); break;
+        case OpSqrtOfSquared:
+            v = fabs(x);
+            if(!(v >= SqrtOfSquaredMin && v < SqrtOfSquaredMax)) v = sqrt(x * x);
+            break;
+        case OpLogOfExp:
+            v = x;
+            if(!(fabs(x) < LogOfExpMax))
+            {
+                double t = exp(x);
+                if(t <= 0) err = NonPositiveLogarithm;
+                v = log(t);
+            }
+            break;
+        case OpCount: break;
+    }
+    return v;
+}
+
+#endif // PROGRAM_H
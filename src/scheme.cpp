@@ -0,0 +1,153 @@
+/**
+ * @file scheme.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief scheme file module
+ *
+ * This module contains the scheme file reader and writer.
+ */
+
+#include <fstream>
+#include <sstream>
+
+#include "debug.h"
+#include "scheme.h"
+
+namespace {
+    /**
+     * @brief Splits the line of the file by commas.
+     * @param s         Line.
+     * @returns Fields.
+     */
+    std::vector<std::string> split(const std::string& s)
+    {
+        std::vector<std::string> v;
+        std::istringstream is(s);
+        std::string f;
+        while(std::getline(is, f, ',')) v.push_back(f);
+        if(!s.empty() && s.back() == ',') v.push_back("");
+        return v;
+    }
+}
+
+SchemeFile Scheme::read(std::istream& is)
+{
+    Debug::File("Scheme::read()");
+    std::string s;
+    if(!getline(is,s) || s != "# BLOCKS #") throw MyError("Invalid input file!", ErrorType::BlockError);
+
+    SchemeFile f;
+    while( getline(is, s) ) {
+        if(s == "# WIRES #") break;
+        if(s == "") continue;
+        std::vector<std::string> v = split(s);
+        try {
+            long id = std::stol(v.at(0));
+            GuiBlockDescriptor g;
+            g.type = std::stol(v.at(1));
+            g.pos = std::make_pair(std::stod(v.at(2)), std::stod(v.at(3)));
+            g.val.type = v.at(4);
+            g.val.valid = (v.at(5) == "true");
+            g.val.value = std::stod(v.at(6));
+            // input count (optional, blocks with N inputs), constant flag (optional, inputs)
+            if(v.size() > 7 && g.type == -1) g.constant = (v.at(7) == "constant");
+            else if(v.size() > 7) g.ports = std::stoi(v.at(7));
+            f.blocks.insert( std::make_pair(id, g) );
+        } catch(std::exception& e) {
+            throw MyError("Invalid input file!", ErrorType::BlockError);
+        }
+    }
+
+    // read wires
+    while( getline(is, s) ) {
+        if(s == "# TYPES #") break;
+        if(s == "") continue;
+        std::vector<std::string> v = split(s);
+        try {
+            struct wireState wire;
+            wire.block1_id = std::stol(v.at(0));
+            wire.block2_id = std::stol(v.at(1));
+            wire.connector1 = std::stoi(v.at(2));
+            wire.connector2 = std::stoi(v.at(3));
+            f.wires.push_back(wire);
+        } catch(std::exception& e) {
+            throw MyError("Invalid input file!", ErrorType::BlockError);
+        }
+    }
+
+    while( getline(is, s) ) {
+        f.types.push_back(s);
+    }
+    return f;
+}
+
+SchemeFile Scheme::load(const std::string& path)
+{
+    std::ifstream is(path);
+    if(!is) throw MyError("Cannot open "+path, ErrorType::BlockError);
+    return read(is);
+}
+
+void Scheme::write(std::ostream& os, const SchemeFile& f)
+{
+    Debug::File("Scheme::write()");
+    // save blocks
+    os << "# BLOCKS #\n";
+    for(auto& it: f.blocks)
+    {
+        os << it.first << ","
+           << it.second.type << ","
+           << it.second.pos.first << ","
+           << it.second.pos.second << ","
+           << it.second.val.type << ","
+           << (it.second.val.valid ? "true" : "false") << ","
+           << it.second.val.value;
+        if(it.second.ports > 0) os << "," << it.second.ports;
+        if(it.second.constant) os << ",constant";
+        os << "\n";
+    }
+    // save wires
+    os << "# WIRES #\n";
+    for(auto& it: f.wires)
+    {
+        os << it.block1_id << ","
+           << it.block2_id << ","
+           << it.connector1 << ","
+           << it.connector2 << "\n";
+    }
+    // save types
+    os << "# TYPES #\n";
+    for(auto& it: f.types)
+    {
+        os << it << "\n";
+    }
+}
+
+ModelState Scheme::getModelState(const SchemeFile& f)
+{
+    ModelState ms;
+    for(auto& it: f.blocks)
+    {
+        ms.blocks.insert( std::make_pair(it.first, it.second.type) );
+        if(it.second.ports > 0) ms.ports.insert( std::make_pair(it.first, it.second.ports) );
+        if(it.second.constant) ms.constants.insert(it.first);
+    }
+    return ms;
+}
+
+void Scheme::build(const SchemeFile& f, Model& m)
+{
+    Debug::File("Scheme::build()");
+    m.setState(getModelState(f));
+    for(auto& it: f.blocks)
+    {
+        if(it.second.type == -1) m.slotInputValueChanged(it.first, it.second.val);
+    }
+    for(auto& it: f.wires)
+    {
+        long key;
+        bool success = false;
+        m.slotCreateWire({it.block1_id, it.connector1}, {it.block2_id, it.connector2}, key, success);
+        if(!success) throw MyError("Invalid wire "+std::to_string(it.block1_id)+"-"+std::to_string(it.block2_id), ErrorType::WireError);
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * @file scheme.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief scheme file interface
+ *
+ * This module reads and writes the scheme files (.bsc). It does not need
+ * the window, so the scheme can be loaded into the Model without the GUI
+ * (command line modes).
+ */
+
+#ifndef SCHEME_H
+#define SCHEME_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "defs.h"
+#include "model.h"
+
+/**
+ * @brief Contents of the scheme file.
+ */
+struct SchemeFile {
+    std::map<long, GuiBlockDescriptor> blocks; /**< Blocks <id,GuiBlockDescriptor>. */
+    std::vector<struct wireState> wires; /**< Wires. */
+    std::vector<std::string> types; /**< Value types. */
+};
+
+/**
+ * @brief Scheme file namespace.
+ */
+namespace Scheme
+{
+    /**
+     * @brief Reads the scheme.
+     * @param is        Input stream.
+     * @returns Contents of the file.
+     */
+    SchemeFile read(std::istream& is);
+    /**
+     * @brief Reads the scheme from the file.
+     * @param path      Path to the file.
+     * @returns Contents of the file.
+     */
+    SchemeFile load(const std::string& path);
+    /**
+     * @brief Writes the scheme.
+     * @param os        Output stream.
+     * @param f         Contents of the file.
+     */
+    void write(std::ostream& os, const SchemeFile& f);
+    /**
+     * @brief State of the model of the scheme (see Model::setState).
+     * @param f         Contents of the file.
+     * @returns State of the model.
+     */
+    ModelState getModelState(const SchemeFile& f);
+    /**
+     * @brief Builds the scheme in the model without the GUI. Sets the
+     *        blocks, the values of the inputs and connects the wires.
+     * @param f         Contents of the file.
+     * @param m         Model (empty).
+     */
+    void build(const SchemeFile& f, Model& m);
+}
+
+#endif // SCHEME_H
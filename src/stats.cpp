@@ -0,0 +1,255 @@
+/**
+ * @file stats.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief streaming statistics module
+ *
+ * This module contains the streaming statistics implementation.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include "stats.h"
+
+namespace {
+    /** @brief Not a number. */
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+}
+
+/* ---------------------------- Histogram ---------------------------- */
+
+Histogram::Histogram(double lo, double hi, size_t bins):
+    mlo(lo), mhi(hi), mbins(std::max<size_t>(bins, 1), 0)
+{}
+
+void Histogram::add(double v, unsigned long long n)
+{
+    if(v < mlo) { munder += n; return; }
+    if(v > mhi) { mover += n; return; }
+    size_t i = 0;
+    if(mhi > mlo) i = std::min(mbins.size() - 1, size_t((v - mlo) / (mhi - mlo) * double(mbins.size())));
+    mbins[i] += n;
+}
+
+void Histogram::merge(const Histogram& h)
+{
+    if(h.mlo != mlo || h.mhi != mhi || h.mbins.size() != mbins.size())
+        throw MyError("Histograms differ", ErrorType::MathError);
+    for(size_t i = 0; i < mbins.size(); i++) mbins[i] += h.mbins[i];
+    munder += h.munder;
+    mover += h.mover;
+}
+
+/* ------------------------- QuantileSketch -------------------------- */
+
+QuantileSketch::QuantileSketch(double accuracy, size_t maxBuckets):
+    mgamma((1 + accuracy) / (1 - accuracy)), mlog(std::log(mgamma)), mmax(std::max<size_t>(maxBuckets, 2))
+{}
+
+int QuantileSketch::bucket(double v) const { return int(std::ceil(std::log(v) / mlog)); }
+
+double QuantileSketch::value(int i) const { return 2 * std::pow(mgamma, i) / (mgamma + 1); }
+
+void QuantileSketch::add(double v)
+{
+    mcount++;
+    if(std::fabs(v) < DBL_MIN) mzero++;
+    else if(v > 0) mpositive[bucket(v)]++;
+    else mnegative[bucket(-v)]++;
+    if(mpositive.size() + mnegative.size() > mmax) collapse();
+}
+
+void QuantileSketch::merge(const QuantileSketch& s)
+{
+    if(s.mgamma != mgamma) throw MyError("Sketches differ", ErrorType::MathError);
+    for(auto& it: s.mpositive) mpositive[it.first] += it.second;
+    for(auto& it: s.mnegative) mnegative[it.first] += it.second;
+    mzero += s.mzero;
+    mcount += s.mcount;
+    while(mpositive.size() + mnegative.size() > mmax) collapse();
+}
+
+void QuantileSketch::collapse()
+{
+    // the smallest magnitudes of the larger side lose the accuracy
+    std::map<int,unsigned long long>& m = (mpositive.size() >= mnegative.size()) ? mpositive : mnegative;
+    if(m.size() < 2) return;
+    auto first = m.begin();
+    std::next(first)->second += first->second;
+    m.erase(first);
+}
+
+double QuantileSketch::getQuantile(double q) const
+{
+    if(mcount == 0) return NaN;
+    double rank = std::min(std::max(q, 0.0), 1.0) * double(mcount - 1);
+    unsigned long long n = 0;
+    for(auto it = mnegative.rbegin(); it != mnegative.rend(); ++it)
+    {
+        n += it->second;
+        if(double(n) > rank) return -value(it->first);
+    }
+    n += mzero;
+    if(double(n) > rank) return 0;
+    for(auto& it: mpositive)
+    {
+        n += it.second;
+        if(double(n) > rank) return value(it.first);
+    }
+    return mpositive.empty() ? 0 : value(mpositive.rbegin()->first);
+}
+
+Histogram QuantileSketch::getHistogram(double lo, double hi, size_t bins) const
+{
+    // the values of the buckets may be a bit off the bounds
+    Histogram h(lo, hi, bins);
+    auto clamp = [lo, hi](double v) { return std::min(std::max(v, lo), hi); };
+    for(auto& it: mnegative) h.add(clamp(-value(it.first)), it.second);
+    if(mzero > 0) h.add(clamp(0), mzero);
+    for(auto& it: mpositive) h.add(clamp(value(it.first)), it.second);
+    return h;
+}
+
+/* ------------------------------ Stats ------------------------------ */
+
+Stats::Stats(const StatsOptions& o):
+    moptions(o), msketch(o.accuracy, o.maxBuckets), mhistogram(o.lo, o.hi, o.bins)
+{}
+
+void Stats::add(double v, EvalError e)
+{
+    if(e != EvalError::EvalOk || !std::isfinite(v))
+    {
+        merrors++;
+        return;
+    }
+    mcount++;
+    if(mcount == 1) { mmin = v; mmax = v; }
+    else { mmin = std::min(mmin, v); mmax = std::max(mmax, v); }
+    // Welford
+    double d = v - mmean;
+    mmean += d / double(mcount);
+    mm2 += d * (v - mmean);
+    msketch.add(v);
+    if(moptions.hi > moptions.lo) mhistogram.add(v);
+}
+
+void Stats::merge(const Stats& s)
+{
+    merrors += s.merrors;
+    if(s.mcount == 0) return;
+    if(mcount == 0)
+    {
+        unsigned long long errors = merrors;
+        *this = s;
+        merrors = errors;
+        return;
+    }
+    // Chan et al.
+    double n = double(mcount + s.mcount);
+    double d = s.mmean - mmean;
+    mmean += d * double(s.mcount) / n;
+    mm2 += s.mm2 + d * d * double(mcount) * double(s.mcount) / n;
+    mcount += s.mcount;
+    mmin = std::min(mmin, s.mmin);
+    mmax = std::max(mmax, s.mmax);
+    msketch.merge(s.msketch);
+    if(moptions.hi > moptions.lo) mhistogram.merge(s.mhistogram);
+}
+
+double Stats::getMean() const { return (mcount > 0) ? mmean : NaN; }
+double Stats::getVariance() const { return (mcount > 1) ? mm2 / double(mcount - 1) : NaN; }
+double Stats::getMin() const { return (mcount > 0) ? mmin : NaN; }
+double Stats::getMax() const { return (mcount > 0) ? mmax : NaN; }
+
+Histogram Stats::getHistogram() const
+{
+    if(moptions.hi > moptions.lo) return mhistogram;
+    if(mcount == 0) return Histogram(0, 0, moptions.bins);
+    return msketch.getHistogram(mmin, mmax, moptions.bins);
+}
+
+std::string Stats::toString() const
+{
+    std::ostringstream os;
+    os << "Samples: " << mcount;
+    if(merrors > 0) os << " (errors: " << merrors << ")";
+    if(mcount == 0) return os.str();
+    os << "\nMean: " << getMean();
+    if(mcount > 1) os << "\nDeviation: " << std::sqrt(getVariance());
+    os << "\nMin: " << getMin() << "\nMax: " << getMax()
+       << "\nMedian: " << getQuantile(0.5)
+       << "\n5% - 95%: " << getQuantile(0.05) << " - " << getQuantile(0.95);
+
+    // bars of the histogram
+    static const char* bars[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    Histogram h = getHistogram();
+    unsigned long long top = 0;
+    for(auto& it: h.getBins()) top = std::max(top, it);
+    os << "\nHistogram: ";
+    for(auto& it: h.getBins()) os << ((it == 0) ? " " : bars[(it * 7) / top]);
+    return os.str();
+}
+
+/* ------------------------- StatsCollector -------------------------- */
+
+StatsCollector::StatsCollector(const std::vector<long>& outputs, const StatsOptions& o):
+    moptions(o), moutputs(outputs)
+{}
+
+size_t StatsCollector::source(long id)
+{
+    auto it = msources.find(id);
+    if(it != msources.end()) return it->second;
+    auto o = std::find(moutputs.begin(), moutputs.end(), id);
+    if(o == moutputs.end()) throw MyError("Block "+std::to_string(id)+" is not evaluated", ErrorType::BlockError);
+    mstats.emplace_back(moptions);
+    mcolumns.push_back(size_t(o - moutputs.begin()));
+    msources[id] = mstats.size() - 1;
+    return mstats.size() - 1;
+}
+
+void StatsCollector::attachBlock(long id) { mblocks[id] = source(id); }
+
+void StatsCollector::attachWire(long id, long source) { mwires[id] = this->source(source); }
+
+void StatsCollector::add(const double* outputs, const EvalError* errors)
+{
+    for(size_t i = 0; i < mstats.size(); i++) mstats[i].add(outputs[mcolumns[i]], errors[mcolumns[i]]);
+}
+
+void StatsCollector::add(const BatchResults& r)
+{
+    for(auto& it: msources)
+    {
+        if(!r.has(it.first)) continue;
+        Stats& s = mstats[it.second];
+        for(size_t row = 0; row < r.getRows(); row++) s.add(r.getValue(it.first, row), r.getError(it.first, row));
+    }
+}
+
+void StatsCollector::merge(const StatsCollector& c)
+{
+    if(c.msources != msources) throw MyError("Collectors differ", ErrorType::BlockError);
+    for(size_t i = 0; i < mstats.size(); i++) mstats[i].merge(c.mstats[i]);
+}
+
+SimulationResults StatsCollector::getResults() const
+{
+    SimulationResults r;
+    auto result = [this](size_t i) {
+        Result res;
+        res.value = mstats[i].getMean();
+        res.type = "statistics";
+        res.level = 0;
+        res.details = mstats[i].toString();
+        return res;
+    };
+    for(auto& it: mblocks) r.blocks[0][it.first] = result(it.second);
+    for(auto& it: mwires) r.wires[0][it.first] = result(it.second);
+    return r;
+}
@@ -0,0 +1,330 @@
+/**
+ * @file stats.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief streaming statistics interface
+ *
+ * This module aggregates the results of many evaluated rows without
+ * keeping them. Every attached block (or wire, which has the value of
+ * its source block) has the count, the mean, the variance, the minimum,
+ * the maximum, the histogram and the quantile sketch of its values. The
+ * memory depends only on the count of the attached blocks. The states
+ * are mergeable, so every thread aggregates its own rows.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "defs.h"
+#include "plan.h"
+
+/**
+ * @brief Options of the aggregation.
+ */
+struct StatsOptions {
+    double accuracy = 0.01; /**< Relative accuracy of the quantiles. */
+    size_t maxBuckets = 2048; /**< Buckets of the quantile sketch (the smallest values are merged above). */
+    size_t bins = 20; /**< Bins of the histogram. */
+    double lo = 0; /**< Lower bound of the histogram. */
+    double hi = 0; /**< Upper bound of the histogram (if not above lo, it is made of the sketch). */
+};
+
+/**
+ * @brief Histogram with the bins of the same width.
+ */
+class Histogram
+{
+    public:
+        /**
+         * @brief Histogram constructor.
+         * @param lo        Lower bound.
+         * @param hi        Upper bound.
+         * @param bins      Count of the bins.
+         */
+        Histogram(double lo = 0, double hi = 1, size_t bins = 1);
+
+        /**
+         * @brief Adds the value.
+         * @param v         Value.
+         * @param n         Count of the values.
+         */
+        void add(double v, unsigned long long n = 1);
+        /**
+         * @brief Adds the other histogram (same bounds and bins).
+         * @param h         Histogram.
+         */
+        void merge(const Histogram& h);
+
+        /**
+         * @brief Lower bound getter.
+         * @returns Lower bound.
+         */
+        double getLo() const { return mlo; }
+        /**
+         * @brief Upper bound getter.
+         * @returns Upper bound.
+         */
+        double getHi() const { return mhi; }
+        /**
+         * @brief Bins getter.
+         * @returns Counts of the values in the bins.
+         */
+        const std::vector<unsigned long long>& getBins() const { return mbins; }
+        /**
+         * @brief Underflow getter.
+         * @returns Count of the values below the lower bound.
+         */
+        unsigned long long getUnder() const { return munder; }
+        /**
+         * @brief Overflow getter.
+         * @returns Count of the values above the upper bound.
+         */
+        unsigned long long getOver() const { return mover; }
+
+    private:
+        double mlo; /**< Lower bound. */
+        double mhi; /**< Upper bound. */
+        std::vector<unsigned long long> mbins; /**< Bins. */
+        unsigned long long munder = 0; /**< Values below. */
+        unsigned long long mover = 0; /**< Values above. */
+};
+
+/**
+ * @brief Quantile sketch with the relative accuracy. The values fall into
+ *        the buckets growing geometrically, so the quantile is known up to
+ *        the width of the bucket.
+ */
+class QuantileSketch
+{
+    public:
+        /**
+         * @brief QuantileSketch constructor.
+         * @param accuracy      Relative accuracy.
+         * @param maxBuckets    Maximal count of the buckets.
+         */
+        QuantileSketch(double accuracy = 0.01, size_t maxBuckets = 2048);
+
+        /**
+         * @brief Adds the value.
+         * @param v         Value (finite).
+         */
+        void add(double v);
+        /**
+         * @brief Adds the other sketch (same accuracy).
+         * @param s         Sketch.
+         */
+        void merge(const QuantileSketch& s);
+        /**
+         * @brief Quantile getter.
+         * @param q         Quantile in [0,1].
+         * @returns Value (NaN if empty).
+         */
+        double getQuantile(double q) const;
+        /**
+         * @brief Histogram of the sketch.
+         * @param lo        Lower bound.
+         * @param hi        Upper bound.
+         * @param bins      Count of the bins.
+         * @returns Histogram (each bucket counted at its value).
+         */
+        Histogram getHistogram(double lo, double hi, size_t bins) const;
+        /**
+         * @brief Count getter.
+         * @returns Count of the values.
+         */
+        unsigned long long getCount() const { return mcount; }
+
+    private:
+        double mgamma; /**< Ratio of the bounds of the bucket. */
+        double mlog; /**< Logarithm of the ratio. */
+        size_t mmax; /**< Maximal count of the buckets. */
+        std::map<int,unsigned long long> mpositive; /**< Buckets of the positive values. */
+        std::map<int,unsigned long long> mnegative; /**< Buckets of the negative values (by the magnitude). */
+        unsigned long long mzero = 0; /**< Count of the zeros (and the tiny values). */
+        unsigned long long mcount = 0; /**< Count of the values. */
+
+        /**
+         * @brief Bucket of the magnitude.
+         * @param v         Positive value.
+         * @returns Index of the bucket.
+         */
+        int bucket(double v) const;
+        /**
+         * @brief Value of the bucket.
+         * @param i         Index of the bucket.
+         * @returns Representative magnitude.
+         */
+        double value(int i) const;
+        /**
+         * @brief Merges the buckets of the smallest magnitudes over the limit.
+         */
+        void collapse();
+};
+
+/**
+ * @brief Statistics of one block.
+ */
+class Stats
+{
+    public:
+        /**
+         * @brief Stats constructor.
+         * @param o         Options.
+         */
+        Stats(const StatsOptions& o = StatsOptions());
+
+        /**
+         * @brief Adds the value. The erroneous and the infinite values are only counted.
+         * @param v         Value.
+         * @param e         Error of the value.
+         */
+        void add(double v, EvalError e = EvalError::EvalOk);
+        /**
+         * @brief Adds the other statistics (same options).
+         * @param s         Statistics.
+         */
+        void merge(const Stats& s);
+
+        /**
+         * @brief Count getter.
+         * @returns Count of the correct values.
+         */
+        unsigned long long getCount() const { return mcount; }
+        /**
+         * @brief Errors getter.
+         * @returns Count of the erroneous values.
+         */
+        unsigned long long getErrors() const { return merrors; }
+        /**
+         * @brief Mean getter.
+         * @returns Mean (NaN if empty).
+         */
+        double getMean() const;
+        /**
+         * @brief Variance getter.
+         * @returns Sample variance (NaN if less than two values).
+         */
+        double getVariance() const;
+        /**
+         * @brief Minimum getter.
+         * @returns Minimum (NaN if empty).
+         */
+        double getMin() const;
+        /**
+         * @brief Maximum getter.
+         * @returns Maximum (NaN if empty).
+         */
+        double getMax() const;
+        /**
+         * @brief Quantile getter.
+         * @param q         Quantile in [0,1].
+         * @returns Value (within the accuracy).
+         */
+        double getQuantile(double q) const { return msketch.getQuantile(q); }
+        /**
+         * @brief Histogram getter. Without the bounds in the options, it is
+         *        made of the sketch between the minimum and the maximum.
+         * @returns Histogram.
+         */
+        Histogram getHistogram() const;
+        /**
+         * @brief Describes the statistics (tooltip).
+         * @returns Text.
+         */
+        std::string toString() const;
+
+    private:
+        StatsOptions moptions; /**< Options. */
+        unsigned long long mcount = 0; /**< Count of the correct values. */
+        unsigned long long merrors = 0; /**< Count of the erroneous values. */
+        double mmean = 0; /**< Mean. */
+        double mm2 = 0; /**< Sum of the squared differences from the mean. */
+        double mmin = 0; /**< Minimum. */
+        double mmax = 0; /**< Maximum. */
+        QuantileSketch msketch; /**< Quantiles. */
+        Histogram mhistogram; /**< Histogram (with the bounds in the options). */
+};
+
+/**
+ * @brief Statistics of the attached blocks and wires over the rows.
+ */
+class StatsCollector
+{
+    public:
+        /**
+         * @brief StatsCollector constructor.
+         * @param outputs   IDs of the outputs of the evaluated rows (see Program::getOutputs).
+         * @param o         Options.
+         */
+        StatsCollector(const std::vector<long>& outputs, const StatsOptions& o = StatsOptions());
+
+        /**
+         * @brief Attaches the block.
+         * @param id        ID of the block (output).
+         */
+        void attachBlock(long id);
+        /**
+         * @brief Attaches the wire. It shares the statistics of its source.
+         * @param id        ID of the wire.
+         * @param source    ID of the source block (output).
+         */
+        void attachWire(long id, long source);
+
+        /**
+         * @brief Adds the row.
+         * @param outputs   Values of the outputs.
+         * @param errors    Errors of the outputs.
+         */
+        void add(const double* outputs, const EvalError* errors);
+        /**
+         * @brief Adds the rows of the batch evaluation of the plan.
+         * @param r         Results.
+         */
+        void add(const BatchResults& r);
+        /**
+         * @brief Adds the other collector (same outputs and attachments).
+         * @param c         Collector.
+         */
+        void merge(const StatsCollector& c);
+
+        /**
+         * @brief Statistics of the block getter.
+         * @param id        ID of the block.
+         * @returns Statistics.
+         */
+        const Stats& getBlock(long id) const { return mstats.at(mblocks.at(id)); }
+        /**
+         * @brief Statistics of the wire getter.
+         * @param id        ID of the wire.
+         * @returns Statistics.
+         */
+        const Stats& getWire(long id) const { return mstats.at(mwires.at(id)); }
+        /**
+         * @brief Results of the attached blocks and wires. The value is the mean,
+         *        the details describe the statistics.
+         * @returns Results (level 0).
+         */
+        SimulationResults getResults() const;
+
+    private:
+        StatsOptions moptions; /**< Options. */
+        std::vector<long> moutputs; /**< IDs of the outputs. */
+        std::vector<Stats> mstats; /**< Statistics of the attached sources. */
+        std::vector<size_t> mcolumns; /**< Output of each statistics. */
+        std::map<long,size_t> msources; /**< Statistics of the source blocks. */
+        std::map<long,size_t> mblocks; /**< Attached blocks. */
+        std::map<long,size_t> mwires; /**< Attached wires. */
+
+        /**
+         * @brief Statistics of the source block (added when missing).
+         * @param id        ID of the block.
+         * @returns Index of the statistics.
+         */
+        size_t source(long id);
+};
+
+#endif // STATS_H
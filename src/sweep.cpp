@@ -0,0 +1,250 @@
+/**
+ * @file sweep.cpp
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief parameter sweep module
+ *
+ * This module contains the parameter sweep implementation.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "debug.h"
+#include "defs.h"
+#include "sweep.h"
+
+namespace {
+    /**
+     * @brief Mixes the bits (finalizer of splitmix64).
+     * @param x         Number.
+     * @returns Mixed number.
+     */
+    unsigned long long mix(unsigned long long x)
+    {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    /**
+     * @brief Inverse of the standard normal distribution (Acklam's approximation).
+     * @param p         Probability in (0,1).
+     * @returns Quantile.
+     */
+    double inverseNormal(double p)
+    {
+        static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                    1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+        static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                    6.680131188771972e+01, -1.328068155288572e+01};
+        static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                   -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+        static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                   3.754408661907416e+00};
+        const double low = 0.02425;
+        if(p < low)
+        {
+            double q = std::sqrt(-2 * std::log(p));
+            return (((((c[0]*q+c[1])*q+c[2])*q+c[3])*q+c[4])*q+c[5]) / ((((d[0]*q+d[1])*q+d[2])*q+d[3])*q+1);
+        }
+        if(p > 1 - low)
+        {
+            double q = std::sqrt(-2 * std::log(1 - p));
+            return -(((((c[0]*q+c[1])*q+c[2])*q+c[3])*q+c[4])*q+c[5]) / ((((d[0]*q+d[1])*q+d[2])*q+d[3])*q+1);
+        }
+        double q = p - 0.5, r = q * q;
+        return (((((a[0]*r+a[1])*r+a[2])*r+a[3])*r+a[4])*r+a[5])*q / (((((b[0]*r+b[1])*r+b[2])*r+b[3])*r+b[4])*r+1);
+    }
+}
+
+Sweep::Sweep(const Plan& p, SweepMode mode, const std::vector<SweepAxis>& axes,
+             size_t points, unsigned long long seed):
+    mprogram(Program::compile(p)), mmode(mode), maxes(axes), mdefaults(p.getDefaults()),
+    mpoints(points), mseed(seed)
+{
+    Debug::Compute("Sweep::Sweep()");
+    const std::vector<long>& inputs = mprogram.getInputs();
+    for(auto& it: maxes)
+    {
+        auto i = std::find(inputs.begin(), inputs.end(), it.id);
+        if(i == inputs.end())
+            throw MyError("Block "+std::to_string(it.id)+" is not a variable input", ErrorType::BlockError);
+        mcolumns.push_back(unsigned(i - inputs.begin()));
+    }
+
+    if(mmode == SweepMode::Grid)
+    {
+        mpoints = 1;
+        for(auto& it: maxes)
+        {
+            if(it.steps == 0) throw MyError("Grid needs at least one step", ErrorType::BlockError);
+            if(mpoints > std::numeric_limits<size_t>::max() / it.steps)
+                throw MyError("Too many points of the grid", ErrorType::BlockError);
+            mpoints *= it.steps;
+        }
+    }
+    // the permutation works on the even count of bits
+    while((size_t(1) << mbits) < mpoints && mbits < 62) mbits += 2;
+}
+
+size_t Sweep::permute(size_t axis, size_t index) const
+{
+    if(mpoints <= 1) return 0;
+    // Feistel network, the values out of the range are walked again
+    const unsigned half = mbits / 2;
+    const unsigned long long mask = (1ull << half) - 1;
+    const unsigned long long key = mix(mseed ^ mix(axis + 0x5eed));
+    unsigned long long x = index;
+    do
+    {
+        unsigned long long l = x >> half, r = x & mask;
+        for(unsigned round = 0; round < 4; round++)
+        {
+            unsigned long long t = l ^ (mix(key + r * 4 + round) & mask);
+            l = r;
+            r = t;
+        }
+        x = (l << half) | r;
+    } while(x >= mpoints);
+    return size_t(x);
+}
+
+double Sweep::random(size_t axis, size_t index) const
+{
+    unsigned long long x = mix(mseed ^ mix(mix(axis) + index));
+    return double(x >> 11) * 0x1.0p-53;
+}
+
+void Sweep::point(size_t index, double* values) const
+{
+    size_t rest = index;
+    for(size_t k = maxes.size(); k-- > 0;)
+    {
+        const SweepAxis& ax = maxes[k];
+        if(mmode == SweepMode::Grid)
+        {
+            // the last axis changes the fastest
+            size_t step = rest % ax.steps;
+            rest /= ax.steps;
+            values[k] = (ax.steps == 1) ? ax.a : ax.a + (ax.b - ax.a) * double(step) / double(ax.steps - 1);
+            continue;
+        }
+        double u = random(k, index);
+        if(mmode == SweepMode::LatinHypercube) u = (double(permute(k, index)) + u) / double(mpoints);
+        if(ax.dist == SweepDistribution::Normal)
+            values[k] = ax.a + ax.b * inverseNormal(std::max(u, 0x1.0p-54));
+        else
+            values[k] = ax.a + (ax.b - ax.a) * u;
+    }
+}
+
+unsigned Sweep::getThreads(size_t batch, unsigned threads) const
+{
+    if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t batches = (mpoints + batch - 1) / batch;
+    return unsigned(std::min<size_t>(threads, std::max<size_t>(batches, 1)));
+}
+
+void Sweep::run(const Sink& sink, size_t batch, unsigned threads) const
+{
+    work([&sink](unsigned, size_t first, size_t rows, const double* in, const double* out, const EvalError* err) {
+        sink(first, rows, in, out, err);
+    }, true, batch, threads);
+}
+
+void Sweep::aggregate(StatsCollector& stats, size_t batch, unsigned threads) const
+{
+    if(batch == 0) batch = 1;
+    // own collector for every thread, no locking in the loop
+    std::vector<StatsCollector> local(getThreads(batch, threads), stats);
+    const size_t no = mprogram.getOutputs().size();
+    work([&local, no](unsigned t, size_t, size_t rows, const double*, const double* out, const EvalError* err) {
+        for(size_t i = 0; i < rows; i++) local[t].add(out + i*no, err + i*no);
+    }, false, batch, threads);
+    for(auto& it: local) stats.merge(it);
+}
+
+void Sweep::work(const std::function<void(unsigned, size_t, size_t, const double*, const double*,
+                                          const EvalError*)>& f,
+                 bool ordered, size_t batch, unsigned threads) const
+{
+    if(batch == 0) batch = 1;
+    threads = getThreads(batch, threads);
+    const size_t batches = (mpoints + batch - 1) / batch;
+    Debug::Compute("Sweep::work(points, threads)", mpoints, threads);
+    if(mprogress != nullptr) mprogress->total = mpoints;
+
+    std::atomic<size_t> next(0);
+    size_t emitted = 0;
+    std::atomic<bool> stop(false);
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    auto worker = [&](unsigned t) {
+        Program prg = mprogram;
+        const size_t na = maxes.size(), no = prg.getOutputs().size();
+        std::vector<double> row = mdefaults;
+        std::vector<double> in(batch * na), out(batch * no);
+        std::vector<EvalError> err(batch * no);
+        try
+        {
+            for(size_t b = next++; b < batches; b = next++)
+            {
+                size_t first = b * batch, rows = std::min(batch, mpoints - first);
+                Debug::Span span(Debug::TraceCompute, "Sweep::batch(first, rows)", first, rows);
+                // the native function is taken, when it gets ready
+                NativeEngine::EvalFunc native = mnative ? mnative->getFunction() : nullptr;
+                for(size_t i = 0; i < rows; i++)
+                {
+                    double* values = in.data() + i * na;
+                    point(first + i, values);
+                    for(size_t k = 0; k < na; k++) row[mcolumns[k]] = values[k];
+                    if(native != nullptr)
+                        native(row.data(), out.data() + i * no, reinterpret_cast<unsigned char*>(err.data() + i * no));
+                    else
+                        prg.run(row.data(), out.data() + i * no, err.data() + i * no);
+                }
+                if(mprogress != nullptr)
+                {
+                    mprogress->done += rows;
+                    if(mprogress->isCancelled()) throw MyError("Computation cancelled", ErrorType::Cancelled);
+                }
+                if(!ordered)
+                {
+                    if(stop) return;
+                    f(t, first, rows, in.data(), out.data(), err.data());
+                    continue;
+                }
+                // the batches are passed on in order
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return emitted == b || stop; });
+                if(stop) return;
+                f(t, first, rows, in.data(), out.data(), err.data());
+                emitted++;
+                cv.notify_all();
+            }
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(!error) error = std::current_exception();
+            stop = true;
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for(unsigned i = 1; i < threads; i++) pool.emplace_back(worker, i);
+    worker(0);
+    for(auto& it: pool) it.join();
+    if(error) std::rethrow_exception(error);
+}
@@ -0,0 +1,184 @@
+/**
+ * @file sweep.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief parameter sweep interface
+ *
+ * This module evaluates the scheme over many points of the chosen inputs
+ * (a grid, a Latin hypercube or Monte Carlo samples). The points are made
+ * from their index when needed, they are evaluated by the compiled program
+ * in batches on all the cores and passed to the sink batch after batch in
+ * the order of the points, so the memory does not depend on their count.
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "native.h"
+#include "plan.h"
+#include "program.h"
+#include "stats.h"
+
+/**
+ * @brief Sampling of the points.
+ */
+enum SweepMode {
+    Grid, /**< All the combinations of the steps. */
+    LatinHypercube, /**< Every stratum of every input sampled once. */
+    MonteCarlo /**< Independent samples. */
+};
+
+/**
+ * @brief Distribution of the swept input.
+ */
+enum SweepDistribution {
+    Uniform, /**< Uniform between a and b. */
+    Normal /**< Normal with the mean a and the deviation b. */
+};
+
+/**
+ * @brief Swept input.
+ */
+struct SweepAxis {
+    long id; /**< ID of the input block. */
+    SweepDistribution dist = Uniform; /**< Distribution (grid is always uniform). */
+    double a = 0; /**< Lower bound, or the mean. */
+    double b = 1; /**< Upper bound, or the deviation. */
+    size_t steps = 2; /**< Steps from a to b including both (grid only). */
+};
+
+/**
+ * @brief Parameter sweep.
+ */
+class Sweep
+{
+    public:
+        /**
+         * @brief Receives the batch of the results. The arrays are valid only
+         *        during the call, they hold rows of the swept inputs (axes order)
+         *        and rows of the outputs (order of getProgram().getOutputs()).
+         * @param first     Index of the first point.
+         * @param rows      Count of the points.
+         * @param inputs    Values of the swept inputs.
+         * @param outputs   Values of the outputs.
+         * @param errors    Errors of the outputs.
+         */
+        typedef std::function<void(size_t first, size_t rows, const double* inputs,
+                                   const double* outputs, const EvalError* errors)> Sink;
+
+        /**
+         * @brief Sweep constructor.
+         * @param p         Plan of the scheme, the other inputs keep its values.
+         * @param mode      Sampling.
+         * @param axes      Swept inputs.
+         * @param points    Count of the points (not used by the grid).
+         * @param seed      Seed of the random sampling.
+         */
+        Sweep(const Plan& p, SweepMode mode, const std::vector<SweepAxis>& axes,
+              size_t points, unsigned long long seed = 0);
+
+        /**
+         * @brief Count of the points getter.
+         * @returns Count of the points.
+         */
+        size_t getPoints() const { return mpoints; }
+        /**
+         * @brief Makes the point. Same index gives always the same point.
+         * @param index     Index of the point.
+         * @param values    Values of the swept inputs (axes order).
+         */
+        void point(size_t index, double* values) const;
+        /**
+         * @brief Evaluates all the points. Every thread has its own copy of
+         *        the program and the buffers of one batch.
+         * @param sink      Receiver of the results, called from one thread at
+         *                  a time, in the order of the points.
+         * @param batch     Count of the points in the batch.
+         * @param threads   Count of the threads (all the cores if 0).
+         */
+        void run(const Sink& sink, size_t batch = 1024, unsigned threads = 0) const;
+        /**
+         * @brief Evaluates all the points into the statistics. Every thread
+         *        fills its own copy of the collector, they are merged at the end.
+         * @param stats     Collector (over the outputs of getProgram()).
+         * @param batch     Count of the points in the batch.
+         * @param threads   Count of the threads (all the cores if 0).
+         */
+        void aggregate(StatsCollector& stats, size_t batch = 1024, unsigned threads = 0) const;
+
+        /**
+         * @brief Program getter.
+         * @returns Program.
+         */
+        const Program& getProgram() const { return mprogram; }
+        /**
+         * @brief Axes getter.
+         * @returns Swept inputs.
+         */
+        const std::vector<SweepAxis>& getAxes() const { return maxes; }
+        /**
+         * @brief Progress setter. The evaluation reports the points done to it
+         *        and throws MyError with ErrorType::Cancelled, when cancelled.
+         * @param p         Progress (nullptr, if not watched).
+         */
+        void setProgress(ComputeProgress* p) { mprogress = p; }
+        /**
+         * @brief Compiles the program into the native code in the background
+         *        (see NativeEngine). The batches are evaluated by the native
+         *        function once it is ready, by the bytecode before.
+         * @param on        Uses the native code, if true.
+         */
+        void setNative(bool on) { mnative = on ? std::make_shared<NativeEngine>(mprogram) : nullptr; }
+
+        static constexpr size_t NativePoints = 100000; /**< Count of the points, from which the compilation pays off. */
+
+    private:
+        Program mprogram; /**< Program. */
+        SweepMode mmode; /**< Sampling. */
+        std::vector<SweepAxis> maxes; /**< Swept inputs. */
+        std::vector<unsigned> mcolumns; /**< Index of the input of each axis. */
+        std::vector<double> mdefaults; /**< Values of the inputs. */
+        size_t mpoints; /**< Count of the points. */
+        unsigned long long mseed; /**< Seed. */
+        unsigned mbits = 0; /**< Bits of the permutation of the hypercube. */
+        ComputeProgress* mprogress = nullptr; /**< Progress of the evaluation. */
+        std::shared_ptr<NativeEngine> mnative; /**< Native code (nullptr, if not used). */
+
+        /**
+         * @brief Permutes the index of the stratum (hypercube).
+         * @param axis      Axis.
+         * @param index     Index of the point.
+         * @returns Index of the stratum.
+         */
+        size_t permute(size_t axis, size_t index) const;
+        /**
+         * @brief Random number in [0,1).
+         * @param axis      Axis.
+         * @param index     Index of the point.
+         * @returns Number.
+         */
+        double random(size_t axis, size_t index) const;
+        /**
+         * @brief Evaluates the batches on the threads.
+         * @param f         Receiver of the batch (index of the thread first).
+         * @param ordered   Batches are received one at a time in their order, if true.
+         * @param batch     Count of the points in the batch.
+         * @param threads   Count of the threads (all the cores if 0).
+         */
+        void work(const std::function<void(unsigned, size_t, size_t, const double*, const double*,
+                                           const EvalError*)>& f,
+                  bool ordered, size_t batch, unsigned threads) const;
+        /**
+         * @brief Count of the threads.
+         * @param batch     Count of the points in the batch.
+         * @param threads   Requested count (all the cores if 0).
+         * @returns Count of the threads used.
+         */
+        unsigned getThreads(size_t batch, unsigned threads) const;
+};
+
+#endif // SWEEP_H
@@ -0,0 +1,162 @@
+/**
+ * @file valuestore.h
+ * @author xbenes49, xpolan09
+ * @date 5 May 2018
+ * @brief value storage
+ *
+ * This module contains the storage of the block values. The values
+ * of all the blocks in the scheme are kept in parallel arrays (value,
+ * validity and type), every block owns one slot in them.
+ */
+
+#ifndef VALUESTORE_H
+#define VALUESTORE_H
+
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "defs.h"
+#include "memoryreport.h"
+
+/**
+ * @brief Storage of the values of one scheme (struct of arrays).
+ */
+class ValueStore
+{
+    public:
+        /**
+         * @brief Allocates a slot (reuses the released ones).
+         * @returns Index of the slot.
+         */
+        long allocate()
+        {
+            if(!mfree.empty())
+            {
+                long slot = mfree.back();
+                mfree.pop_back();
+                invalidate(slot);
+                return slot;
+            }
+            mvalues.push_back(0);
+            mvalid.push_back(false);
+            mtypes.push_back(-1);
+            return long(mvalues.size()) - 1;
+        }
+        /**
+         * @brief Releases the slot, so it may be reused.
+         * @param slot      Slot to release.
+         */
+        void release(long slot)
+        {
+            invalidate(slot);
+            mfree.push_back(slot);
+        }
+        /**
+         * @brief Releases all the slots.
+         */
+        void clear()
+        {
+            mvalues.clear();
+            mvalid.clear();
+            mtypes.clear();
+            mfree.clear();
+        }
+        /**
+         * @brief Count of the slots (including released ones).
+         * @returns Slot count.
+         */
+        size_t size() const { return mvalues.size(); }
+
+        /**
+         * @brief Value getter.
+         * @param slot      Slot.
+         * @returns Raw value in the slot.
+         */
+        double value(long slot) const { return mvalues[slot]; }
+        /**
+         * @brief Validity getter.
+         * @param slot      Slot.
+         * @returns True, if the slot holds a valid value.
+         */
+        bool isValid(long slot) const { return mvalid[slot]; }
+        /**
+         * @brief Type id getter.
+         * @param slot      Slot.
+         * @returns Type id of the value (see Config::getTypeId).
+         */
+        int typeId(long slot) const { return mtypes[slot]; }
+
+        /**
+         * @brief Stores the raw value into the slot and validates it.
+         * @param slot      Slot.
+         * @param value     Value to store.
+         * @param type      Type id of the value.
+         */
+        void set(long slot, double value, int type)
+        {
+            mvalues[slot] = value;
+            mtypes[slot] = type;
+            mvalid[slot] = true;
+        }
+        /**
+         * @brief Invalidates the slot.
+         * @param slot      Slot.
+         */
+        void invalidate(long slot) { mvalid[slot] = false; }
+
+        /**
+         * @brief Builds the Value from the slot.
+         * @param slot      Slot.
+         * @returns Value object.
+         */
+        Value get(long slot) const
+        {
+            Value v;
+            v.value = mvalues[slot];
+            v.valid = mvalid[slot];
+            v.type = (mtypes[slot] < 0) ? "" : Config::getTypeName(mtypes[slot]);
+            return v;
+        }
+        /**
+         * @brief Stores the Value into the slot.
+         * @param slot      Slot.
+         * @param v         Value to store.
+         */
+        void put(long slot, const Value& v)
+        {
+            mvalues[slot] = v.value;
+            mtypes[slot] = Config::getTypeId(v.type);
+            mvalid[slot] = v.valid;
+        }
+        /**
+         * @brief Progress setter. The blocks report to it during the computation.
+         * @param p         Progress (nullptr, if not watched).
+         */
+        void setProgress(ComputeProgress* p) { mprogress = p; }
+        /**
+         * @brief Progress getter.
+         * @returns Progress of the running computation (nullptr, if not watched).
+         */
+        ComputeProgress* getProgress() const { return mprogress; }
+        /**
+         * @brief Adds the memory of the slots to the report.
+         * @param r         Report.
+         */
+        void accountMemory(MemoryReport& r) const
+        {
+            r.addVector("value store", mvalues);
+            r.addVector("value store", mvalid);
+            r.addVector("value store", mtypes);
+            r.addVector("value store", mfree);
+        }
+
+    private:
+        std::vector<double> mvalues; /**< Values of the slots. */
+        std::vector<bool> mvalid; /**< Validity bitset of the slots. */
+        std::vector<int> mtypes; /**< Type ids of the slots. */
+        std::vector<long> mfree; /**< Released slots. */
+        ComputeProgress* mprogress = nullptr; /**< Progress of the running computation. */
+};
+
+#endif // VALUESTORE_H
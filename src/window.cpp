@@ -8,11 +8,14 @@
  * This module contains window implementation.
  */
 
+#include <algorithm>
+
 #include <QFileDialog>
 #include <QInputDialog>
 #include <QHBoxLayout>
 #include <QMenuBar>
 #include <QMessageBox>
+#include <QProgressBar>
 #include <QSplitter>
 #include <QList>        // list of sizes for splitter
 
@@ -72,6 +75,12 @@ Window::Window(QWidget *parent): QWidget(parent)
     QAction *saveAction = menu1->addAction(QString("Save"));
     saveAction->setShortcuts(QKeySequence::Save);
     QObject::connect(saveAction, SIGNAL(triggered()), this, SLOT(slotSave()) );
+    // export program
+    QAction *exportProgramAction = menu1->addAction(QString("Export program"));
+    QObject::connect(exportProgramAction, SIGNAL(triggered()), this, SLOT(slotExportProgram()) );
+    // export C++
+    QAction *exportCppAction = menu1->addAction(QString("Export C++"));
+    QObject::connect(exportCppAction, SIGNAL(triggered()), this, SLOT(slotExportCpp()) );
     // exit
     QAction *exitAction = menu1->addAction(QString("Exit"));
     exitAction->setShortcuts(QKeySequence::Quit);
@@ -88,6 +97,32 @@ Window::Window(QWidget *parent): QWidget(parent)
     QAction *debugAction = menu2->addAction(QString("Debug"));
     debugAction->setShortcuts(QKeySequence::Open);
     QObject::connect(debugAction, SIGNAL(triggered()), this, SLOT(slotDebug()) );
+    // playback
+    QAction *playAction = menu2->addAction(QString("Play"));
+    QObject::connect(playAction, SIGNAL(triggered()), this, SLOT(slotPlay()) );
+    mpause = menu2->addAction(QString("Pause"));
+    mpause->setCheckable(true);
+    mpause->setEnabled(false);
+    QObject::connect(mpause, SIGNAL(toggled(bool)), this, SIGNAL(sigPause(bool)) );
+    QAction *speedAction = menu2->addAction(QString("Playback speed"));
+    QObject::connect(speedAction, SIGNAL(triggered()), this, SLOT(slotPlaybackSpeed()) );
+    // statistics
+    QAction *statisticsAction = menu2->addAction(QString("Statistics"));
+    QObject::connect(statisticsAction, SIGNAL(triggered()), this, SLOT(slotStatistics()) );
+    // profiling
+    QAction *profileAction = menu2->addAction(QString("Profile blocks"));
+    profileAction->setCheckable(true);
+    QObject::connect(profileAction, SIGNAL(toggled(bool)), this, SIGNAL(sigProfile(bool)) );
+    // critical path
+    QAction *analyzeAction = menu2->addAction(QString("Critical path"));
+    QObject::connect(analyzeAction, SIGNAL(triggered()), this, SIGNAL(sigAnalyze()) );
+    // memory
+    QAction *memoryAction = menu2->addAction(QString("Memory usage"));
+    QObject::connect(memoryAction, SIGNAL(triggered()), this, SIGNAL(sigMemory()) );
+    // cancel (enabled, while the computation runs in the background)
+    mcancel = menu2->addAction(QString("Cancel"));
+    mcancel->setEnabled(false);
+    QObject::connect(mcancel, SIGNAL(triggered()), this, SIGNAL(sigCancel()) );
     menubar->addMenu(menu2);
 
     // create types
@@ -112,13 +147,26 @@ Window::Window(QWidget *parent): QWidget(parent)
     //hlayout->setSpacing(0);
     hlayout->addWidget(splitter);
 
+    // progress of the computation in the background
+    mprogress = new QProgressBar(this);
+    mprogress->setRange(0, 1000);
+    mprogress->hide();
+    vlayout->addWidget(mprogress);
+
     QObject::connect(this, SIGNAL(sigRun(bool)), mmenu.get(), SLOT(slotRun(bool)));
 
     mactions.push_back(newAction);
     mactions.push_back(loadAction);
     mactions.push_back(saveAction);
+    mactions.push_back(exportProgramAction);
+    mactions.push_back(exportCppAction);
     mactions.push_back(calculateAction);
     mactions.push_back(debugAction);
+    mactions.push_back(playAction);
+    mactions.push_back(statisticsAction);
+    mactions.push_back(profileAction);
+    mactions.push_back(analyzeAction);
+    mactions.push_back(memoryAction);
     mactions.push_back(addTypeAction);
     mactions.push_back(removeTypeAction);
 }
@@ -154,6 +202,20 @@ void Window::slotSave()
     emit sigSave(filename.toStdString());
 }
 
+void Window::slotExportProgram()
+{
+    QString filename = QFileDialog::getSaveFileName(this, "Export program", ".bsp", "Block program (*.bsp);;All Files (*)");
+    if(filename == "") return;
+    emit sigExportProgram(filename.toStdString());
+}
+
+void Window::slotExportCpp()
+{
+    QString filename = QFileDialog::getSaveFileName(this, "Export C++", ".h", "C++ header (*.h);;All Files (*)");
+    if(filename == "") return;
+    emit sigExportCpp(filename.toStdString());
+}
+
 void Window::slotDebug()
 {
     Debug::Compute("Start debug.");
@@ -167,6 +229,39 @@ void Window::slotCalculate()
     emit sigRun(false);
 }
 
+void Window::slotPlay()
+{
+    Debug::Compute("Start playback.");
+    setCompute(true);
+    mmenu->slotRun(true);
+    emit sigPlay(mlevelrate, mframerate);
+}
+
+void Window::slotPlaybackSpeed()
+{
+    bool ok;
+    double levels = QInputDialog::getDouble(0, "Playback speed", "Levels per second:", mlevelrate, 0.1, 10000, 1, &ok);
+    if(!ok) return;
+    int fps = QInputDialog::getInt(0, "Playback speed", "Frames per second:", mframerate, 1, 120, 1, &ok);
+    if(!ok) return;
+    mlevelrate = levels;
+    mframerate = fps;
+    emit sigPlaybackSpeed(mlevelrate, mframerate);
+}
+
+void Window::slotStatistics()
+{
+    bool ok;
+    int samples = QInputDialog::getInt(0, "Statistics", "Count of the samples:", 10000, 1, 100000000, 1, &ok);
+    if(!ok) return;
+    double spread = QInputDialog::getDouble(0, "Statistics", "Spread of the inputs (%):", 10, 0, 1000, 2, &ok);
+    if(!ok) return;
+    // the scheme must not change, while the samples are evaluated
+    setCompute(true);
+    mmenu->slotRun(false);
+    emit sigStatistics(samples, spread / 100);
+}
+
 void Window::slotAddType()
 {
     bool ok;
@@ -201,7 +296,9 @@ void Window::keyPressEvent(QKeyEvent *event)
     {
         if(event->key() == Qt::Key_Escape)
         {
-            endComputation();
+            // the running computation ends, when it stops
+            if(mbusy) emit sigCancel();
+            else endComputation();
         }
         //else if(event->key() == Qt::Key_A)
         //{
@@ -213,6 +310,16 @@ void Window::keyPressEvent(QKeyEvent *event)
             Debug::Compute("Next step.");
             emit sigNextResult();
         }
+        else if(event->key() == Qt::Key_P && mplaying)
+        {
+            mpause->toggle();
+        }
+        else if((event->key() == Qt::Key_Plus || event->key() == Qt::Key_Minus) && mplaying)
+        {
+            // twice faster or slower
+            mlevelrate = std::max(0.1, std::min(10000.0, mlevelrate * ((event->key() == Qt::Key_Plus) ? 2 : 0.5)));
+            emit sigPlaybackSpeed(mlevelrate, mframerate);
+        }
     }
 
 }
@@ -226,6 +333,29 @@ void Window::endComputation()
     emit sigEndComputation();
 }
 
+void Window::setBusy(bool busy)
+{
+    mbusy = busy;
+    mcancel->setEnabled(busy);
+    if(!busy) mprogress->hide();
+}
+
+void Window::setPlaying(bool playing)
+{
+    mplaying = playing;
+    mpause->setEnabled(playing);
+    if(!playing) mpause->setChecked(false);
+}
+
+void Window::setProgress(unsigned long long done, unsigned long long total)
+{
+    if(total == 0) return;
+    // the range of the bar is int, the counts may be larger
+    mprogress->setValue(int(std::min(done, total) * 1000 / total));
+    mprogress->setFormat(QString("%1 / %2").arg(done).arg(total));
+    mprogress->show();
+}
+
 void Window::showDialog(const char * msg)
 {
     QMessageBox mb(QMessageBox::Critical, "BlockEditor error", QString::fromStdString(msg), QMessageBox::Ok);
@@ -233,6 +363,13 @@ void Window::showDialog(const char * msg)
     endComputation();
 }
 
+void Window::showReport(const std::string& title, const std::string& text, const std::string& details)
+{
+    QMessageBox mb(QMessageBox::Information, QString::fromStdString(title), QString::fromStdString(text), QMessageBox::Ok);
+    if(!details.empty()) mb.setDetailedText(QString::fromStdString(details));
+    mb.exec();
+}
+
 void Window::slotHelp()
 {
 
@@ -13,8 +13,10 @@
 
 #include <iostream>
 #include <memory>
+#include <string>
 
 #include <QAction>
+#include <QProgressBar>
 #include <QWidget>
 
 #include "menu.h"
@@ -80,6 +82,31 @@ class Window: public QWidget
          * @brief Shows alert dialog.
          */
         void showDialog(const char *);
+        /**
+         * @brief Shows the report.
+         * @param title     Title.
+         * @param text      Text.
+         * @param details   Details (hidden at first).
+         */
+        void showReport(const std::string& title, const std::string& text, const std::string& details);
+        /**
+         * @brief Busy setter. While the computation runs in the background,
+         *        it may be cancelled (menu or Escape), but not ended.
+         * @param busy      True, if the computation runs.
+         */
+        void setBusy(bool busy);
+        /**
+         * @brief Shows the progress of the computation.
+         * @param done      Count of the finished blocks (or points).
+         * @param total     Count of all of them.
+         */
+        void setProgress(unsigned long long done, unsigned long long total);
+        /**
+         * @brief Playing setter. While the results are played, the playback
+         *        may be paused and resumed.
+         * @param playing   True, if the results are played.
+         */
+        void setPlaying(bool playing);
 
     public slots:
         /**
@@ -98,6 +125,14 @@ class Window: public QWidget
          * @brief Save button handler.
          */
         void slotSave();
+        /**
+         * @brief Export program button handler.
+         */
+        void slotExportProgram();
+        /**
+         * @brief Export C++ button handler.
+         */
+        void slotExportCpp();
         /**
          * @brief Debug button handler.
          */
@@ -106,6 +141,18 @@ class Window: public QWidget
          * @brief Calculate button handler.
          */
         void slotCalculate();
+        /**
+         * @brief Play button handler.
+         */
+        void slotPlay();
+        /**
+         * @brief Playback speed button handler. Asks for the rates.
+         */
+        void slotPlaybackSpeed();
+        /**
+         * @brief Statistics button handler. Asks for the samples.
+         */
+        void slotStatistics();
         /**
          * @brief Add type button handler.
          */
@@ -138,11 +185,61 @@ class Window: public QWidget
          * @param s         File name.
          */
         void sigSave(std::string);
+        /**
+         * @brief Emitted, when exporting the bytecode to a file.
+         * @param s         File name.
+         */
+        void sigExportProgram(std::string);
+        /**
+         * @brief Emitted, when exporting the C++ header to a file.
+         * @param s         File name.
+         */
+        void sigExportCpp(std::string);
         /**
          * @brief Emitted, when running.
          * @param dbg       True if debug. False if compute.
          */
         void sigRun(bool dbg);
+        /**
+         * @brief Emitted, when the results should be played.
+         * @param levels    Levels shown per second.
+         * @param fps       Frames per second (the updates are coalesced into them).
+         */
+        void sigPlay(double levels, int fps);
+        /**
+         * @brief Emitted, when the playback is paused or resumed.
+         * @param paused    True, if paused.
+         */
+        void sigPause(bool paused);
+        /**
+         * @brief Emitted, when the speed of the playback changes.
+         * @param levels    Levels shown per second.
+         * @param fps       Frames per second.
+         */
+        void sigPlaybackSpeed(double levels, int fps);
+        /**
+         * @brief Emitted, when the statistics of the random runs are requested.
+         * @param samples   Count of the runs.
+         * @param spread    Relative spread of the variable inputs around their values.
+         */
+        void sigStatistics(long samples, double spread);
+        /**
+         * @brief Emitted, when the profiling of the blocks is turned on or off.
+         * @param on        Profiling is on, if true.
+         */
+        void sigProfile(bool on);
+        /**
+         * @brief Emitted, when the critical path is requested.
+         */
+        void sigAnalyze();
+        /**
+         * @brief Emitted, when the memory report is requested.
+         */
+        void sigMemory();
+        /**
+         * @brief Emitted, when the running computation should be cancelled.
+         */
+        void sigCancel();
         /**
          * @brief Emitted, when previous file is needed.
          */
@@ -159,6 +256,13 @@ class Window: public QWidget
         std::shared_ptr<PlayGround> mplayground; /**< Playground. */
         std::shared_ptr<Menu> mmenu; /**< Menu. */
         bool mcompute = false; /**< Compute mode is on. */
+        bool mbusy = false; /**< Computation runs in the background. */
+        QAction *mcancel = nullptr; /**< Cancel action. */
+        QProgressBar *mprogress = nullptr; /**< Progress of the computation. */
+        bool mplaying = false; /**< Results are played. */
+        QAction *mpause = nullptr; /**< Pause action. */
+        double mlevelrate = 10; /**< Levels of the playback per second. */
+        int mframerate = 30; /**< Frames of the playback per second. */
         std::vector<QAction*> mactions;
 
         void setCompute(bool v) 
@@ -11,6 +11,8 @@
 #ifndef WIRE_H
 #define WIRE_H
 
+#include <vector>
+
 #include "defs.h"
 #include "iblock.h"
 
@@ -54,6 +56,26 @@ class Wire
          * @returns Value of the input block.
          */
         Value getValue() const { return mi.getValue(); }
+        /**
+         * @brief Slot getter.
+         * @returns Slot of the input block in the value storage.
+         */
+        long getSlot() const { return mi.getSlot(); }
+        /**
+         * @brief Key getter.
+         * @returns Key of the wire.
+         */
+        long getKey() const { return mkey; }
+        /**
+         * @brief Source getter.
+         * @returns ID of the input block.
+         */
+        long getSource() const { return mi.getId(); }
+        /**
+         * @brief Target getter.
+         * @returns ID of the block, the wire writes.
+         */
+        long getTarget() const { return mo.getId(); }
         /**
          * @brief Value setter (set output).
          * @param value         New value to set.
@@ -82,7 +104,7 @@ class Wire
          */
         SimulationResults& distributeResult(SimulationResults& sr) const
         {
-            Debug::Block("Wire::distributeResult()");
+            Debug::Block("Wire::distributeResult()", mkey);
             Result r;
             Value v = mi.getValue();
 
@@ -104,30 +126,50 @@ class Wire
 };
 
 /**
- * @brief Port of the block.
+ * @brief Port of the block. Input port accepts a single wire,
+ *        output port any number of them (fan-out).
  */
 struct Port
 {
     /** @brief Port constructor. */
-    Port(std::string t, Wire* w = nullptr): type(t), wire(w) {}
+    Port(std::string t): type(t) {}
 
     std::string type = ""; /* Type, that port accepts. */
-    Wire* wire = nullptr;  /* Wire pointer. */
+    std::vector<Wire*> wires; /* Connected wires. */
+    long slot = -1;        /* Slot of the producing block (input port only). */
 
+    /**
+     * @brief Connection indicator.
+     * @returns True, if any wire is connected.
+     */
+    bool isConnected() const { return !wires.empty(); }
+    /**
+     * @brief Adds the memory of the port (not the port itself) to the report.
+     * @param r         Report.
+     */
+    void accountMemory(MemoryReport& r) const { r.addString(type); r.addVector("vectors", wires); }
     /** 
      * @brief Level getter.
      * @returns Level.
      */
-    int getLevel() { check(); return wire->getLevel(); }
+    int getLevel() { check(); return wires.front()->getLevel(); }
     /**
-     * @brief Value getter.
-     * @returns Value.
+     * @brief Connects the wire.
+     * @param w         Wire to connect.
      */
-    Value getValue() { check(); return wire->getValue(); }
+    void connect(Wire* w) { wires.push_back(w); slot = w->getSlot(); }
     /**
-     * @brief Disconnects connected wire.
+     * @brief Disconnects the wire with the given key.
+     * @param key       Key of the wire.
      */
-    void disconnect() { wire = nullptr; }
+    void disconnect(long key)
+    {
+        for(auto it = wires.begin(); it != wires.end(); it++)
+        {
+            if((*it)->getKey() == key) { wires.erase(it); break; }
+        }
+        if(wires.empty()) slot = -1;
+    }
     /**
      * @brief Propagate level towards.
      * @param level     Propagated level value.
@@ -135,7 +177,7 @@ struct Port
      */
     void propagateLevel(int level, std::set<int> prop)
     {
-        if(wire != nullptr) wire->propagateLevel(level, prop);
+        for(auto& it: wires) { it->propagateLevel(level, prop); }
     }
     /**
      * @brief Distributes result from input to output.
@@ -144,8 +186,8 @@ struct Port
      */
     SimulationResults& distributeResult(SimulationResults& r) const 
     {
-        if(wire == nullptr) return r;
-        else return wire->distributeResult(r);
+        for(auto& it: wires) { it->distributeResult(r); }
+        return r;
     }
 
     /**
@@ -153,7 +195,7 @@ struct Port
      */
     void check()
     {
-        if(wire == nullptr)
+        if(wires.empty())
             throw MyError("Port not assigned", ErrorType::WireError);
     }
 };